@@ -0,0 +1,183 @@
+/*
+ * BlockReader.h - read a stream in blocks ahead on a background thread.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef blockreader_h_included
+#define blockreader_h_included
+
+#include "Utility.h"    // for class UnCopyable
+
+#include <condition_variable> // for std::condition_variable
+#include <cstddef>      // for std::size_t
+#include <deque>        // for std::deque<>
+#include <istream>      // for std::istream
+#include <mutex>        // for std::mutex
+#include <thread>       // for std::thread
+#include <vector>       // for std::vector<>
+
+namespace wordindex {
+
+/**
+ * read a stream in blocks on a background thread, a given number of blocks
+ * ahead of the consumer, so that waiting for input overlaps with processing
+ * the previous block. Blocks are passed by swapping buffers, which are reused.
+ */
+class BlockReader : private UnCopyable
+{
+public:
+   /**
+    * the block type.
+    */
+   typedef std::vector< char > block_type;
+
+   /**
+    * constructor; start reading the given stream.
+    */
+   BlockReader( std::istream& is, std::size_t const block_size, std::size_t const depth = 2 )
+   : m_is        ( &is )
+   , m_block_size( block_size )
+   , m_depth     ( depth )
+   , m_done      ( false )
+   , m_stop      ( false )
+   , m_thread    ()
+   {
+      m_thread = std::thread( &BlockReader::run, this );
+   }
+
+   /**
+    * destructor; stop reading.
+    */
+   ~BlockReader()
+   {
+      {
+         std::lock_guard< std::mutex > lock( m_mutex );
+         m_stop = true;
+      }
+      m_changed.notify_all();
+
+      m_thread.join();
+   }
+
+   /**
+    * exchange the given block for the next block read; false at end of input.
+    * The last block may be shorter than the block size, or empty.
+    */
+   const bool next( block_type& block )
+   {
+      std::unique_lock< std::mutex > lock( m_mutex );
+
+      while ( m_full.empty() && !m_done )
+      {
+         m_changed.wait( lock );
+      }
+
+      if ( m_full.empty() )
+      {
+         return false;
+      }
+
+      block.swap( m_full.front() );
+
+      // hand the old buffer back for reuse:
+      m_free.push_back( block_type() );
+      m_free.back().swap( m_full.front() );
+      m_full.pop_front();
+
+      lock.unlock();
+      m_changed.notify_all();
+
+      return true;
+   }
+
+private:
+   /**
+    * read blocks until end of input or stopped (thread function).
+    */
+   void run()
+   {
+      block_type block;
+
+      for ( ;; )
+      {
+         block.resize( m_block_size );
+         m_is->read( &block[ 0 ], block.size() );
+         block.resize( static_cast< std::size_t >( m_is->gcount() ) );
+
+         bool const at_end = !*m_is;
+
+         std::unique_lock< std::mutex > lock( m_mutex );
+
+         while ( m_full.size() >= m_depth && !m_stop )
+         {
+            m_changed.wait( lock );
+         }
+
+         if ( m_stop )
+         {
+            return;
+         }
+
+         m_full.push_back( block_type() );
+         m_full.back().swap( block );
+
+         if ( !m_free.empty() )
+         {
+            block.swap( m_free.back() );
+            m_free.pop_back();
+         }
+
+         m_done = at_end;
+
+         lock.unlock();
+         m_changed.notify_all();
+
+         if ( at_end )
+         {
+            return;
+         }
+      }
+   }
+
+   std::istream*           m_is;         ///< the stream read
+   std::size_t             m_block_size; ///< number of characters per block
+   std::size_t             m_depth;      ///< maximum number of blocks read ahead
+   std::deque< block_type > m_full;      ///< blocks read, in order
+   std::vector< block_type > m_free;     ///< buffers for reuse
+   bool                    m_done;       ///< the last block has been read
+   bool                    m_stop;       ///< stop reading
+   std::mutex              m_mutex;      ///< protects the above
+   std::condition_variable m_changed;    ///< signals changes of the above
+   std::thread             m_thread;     ///< the reading thread
+};
+
+} // namespace wordindex
+
+#endif // blockreader_h_included
+
+/*
+ * end of file
+ */
@@ -55,6 +55,41 @@
 # define typename_type_k typename
 #endif
 
+/**
+ * vector instruction sets: SSE2 at compile time, AVX2 selected at runtime (GNU).
+ */
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+# define _WORDINDEX_HAVE_SSE2
+# if defined( _WORDINDEX_GNU ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#  define _WORDINDEX_HAVE_AVX2
+# endif
+#endif
+
+/**
+ * prefetch the cache line at the given address for reading, if supported.
+ */
+#if defined( _WORDINDEX_GNU ) || defined( _WORDINDEX_INTEL )
+# define _WORDINDEX_PREFETCH( address )  __builtin_prefetch( address )
+#else
+# define _WORDINDEX_PREFETCH( address )
+#endif
+
+/**
+ * batched file system calls through io_uring (Linux), see FileLoader.h.
+ */
+#if defined( __linux__ ) && defined( __has_include )
+# if __has_include( <linux/io_uring.h> )
+#  define _WORDINDEX_HAVE_IO_URING
+# endif
+#endif
+
+/**
+ * relaxed constexpr functions (C++14), e.g. to verify generated tables at compile time.
+ */
+#if __cplusplus >= 201402L || ( defined( _MSVC_LANG ) && _MSVC_LANG >= 201402L )
+# define _WORDINDEX_HAVE_CONSTEXPR14
+#endif
+
 #if defined ( _WORDINDEX_MSC6 )
 namespace std {
 template < typename T >
@@ -0,0 +1,287 @@
+/*
+ * Dictionary.h - interned words with dense word numbers.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef dictionary_h_included
+#define dictionary_h_included
+
+#include "Config.h"     // for _WORDINDEX_PREFETCH()
+#include "Hash.h"       // for hash_type, hash_bytes()
+#include "TokenView.h"  // for class TokenView
+#include "Utility.h"    // for class UnCopyable
+
+#include <cstring>      // for std::memcmp()
+#include <string>       // for std::string
+#include <vector>       // for std::vector<>
+
+namespace wordindex {
+
+/**
+ * set of interned words: the characters of all words are stored back to back
+ * in one pool and each word is known by its dense number (id), in order of
+ * arrival. Words are looked up through an open-addressing hash table.
+ */
+class Dictionary : private UnCopyable
+{
+public:
+   /**
+    * the word number type.
+    */
+   typedef unsigned int id_type;
+
+   /**
+    * the word type.
+    */
+   typedef TokenView word_type;
+
+   /**
+    * the number returned for a word that is not present.
+    */
+   static id_type const npos = ~0u;
+
+   /**
+    * constructor.
+    */
+   Dictionary()
+   : m_offsets( 1, 0 )
+   , m_slots( initial_slots, 0 )
+   {
+      ;
+   }
+
+   /**
+    * number of words.
+    */
+   const id_type size() const
+   {
+      return static_cast< id_type >( m_hashes.size() );
+   }
+
+   /**
+    * true if there are no words.
+    */
+   const bool empty() const
+   {
+      return m_hashes.empty();
+   }
+
+   /**
+    * number of characters in the pool.
+    */
+   const std::size_t pool_size() const
+   {
+      return m_pool.size();
+   }
+
+   /**
+    * the word with the given number; valid until the next word is added.
+    */
+   const word_type word( id_type const id ) const
+   {
+      char const* const pool = m_pool.empty() ? NULL : &m_pool[ 0 ];
+
+      return word_type( pool + m_offsets[ id ], pool + m_offsets[ id + 1 ] );
+   }
+
+   /**
+    * the hash of the word with the given number.
+    */
+   const hash_type hash( id_type const id ) const
+   {
+      return m_hashes[ id ];
+   }
+
+   /**
+    * the number of the word in [first, last) with the given hash; the word is
+    * added if not present; added is set accordingly.
+    */
+   const id_type intern( char const* first, char const* last, hash_type const hash, bool& added )
+   {
+      std::size_t const mask = m_slots.size() - 1;
+
+      for ( std::size_t slot = hash & mask; ; slot = ( slot + 1 ) & mask )
+      {
+         id_type const entry = m_slots[ slot ];
+
+         if ( 0 == entry )
+         {
+            added = true;
+            return add( first, last, hash, slot );
+         }
+
+         if ( m_hashes[ entry - 1 ] == hash && equal( entry - 1, first, last ) )
+         {
+            added = false;
+            return entry - 1;
+         }
+      }
+   }
+
+   /**
+    * the number of the word in [first, last) with the given hash; npos if not present.
+    */
+   const id_type find( char const* first, char const* last, hash_type const hash ) const
+   {
+      std::size_t const mask = m_slots.size() - 1;
+
+      for ( std::size_t slot = hash & mask; ; slot = ( slot + 1 ) & mask )
+      {
+         id_type const entry = m_slots[ slot ];
+
+         if ( 0 == entry )
+         {
+            return npos;
+         }
+
+         if ( m_hashes[ entry - 1 ] == hash && equal( entry - 1, first, last ) )
+         {
+            return entry - 1;
+         }
+      }
+   }
+
+   /**
+    * start loading the hash table slot of a word with the given hash, to look it up soon.
+    */
+   void prefetch( hash_type const hash ) const
+   {
+      _WORDINDEX_PREFETCH( &m_slots[ hash & ( m_slots.size() - 1 ) ] );
+   }
+
+   /**
+    * the number of the given word; the word is added if not present.
+    */
+   const id_type intern( std::string const& s )
+   {
+      bool added = false;
+      return intern( s.data(), s.data() + s.size(), hash_string( s ), added );
+   }
+
+   /**
+    * true if word a orders before word b (byte-wise, like std::string).
+    */
+   const bool less( id_type const a, id_type const b ) const
+   {
+      return word( a ) < word( b );
+   }
+
+   /**
+    * remove all words.
+    */
+   void clear()
+   {
+      m_pool.clear();
+      m_offsets.assign( 1, 0 );
+      m_hashes.clear();
+      m_slots.assign( initial_slots, 0 );
+   }
+
+private:
+   /**
+    * the initial number of hash table slots (a power of two).
+    */
+   enum { initial_slots = 1024 };
+
+   /**
+    * true if word id has the characters [first, last).
+    */
+   const bool equal( id_type const id, char const* first, char const* last ) const
+   {
+      std::size_t const size = last - first;
+
+      return m_offsets[ id + 1 ] - m_offsets[ id ] == size && 0 == std::memcmp( &m_pool[ 0 ] + m_offsets[ id ], first, size );
+   }
+
+   /**
+    * add a new word in the given free slot.
+    */
+   const id_type add( char const* first, char const* last, hash_type const hash, std::size_t const slot )
+   {
+      id_type const id = size();
+
+      m_pool.insert( m_pool.end(), first, last );
+      m_offsets.push_back( m_pool.size() );
+      m_hashes.push_back( hash );
+      m_slots[ slot ] = id + 1;
+
+      // keep the load factor below one half:
+      if ( 2 * m_hashes.size() > m_slots.size() )
+      {
+         rehash( 2 * m_slots.size() );
+      }
+      return id;
+   }
+
+   /**
+    * rebuild the hash table with the given number of slots.
+    */
+   void rehash( std::size_t const size )
+   {
+      m_slots.assign( size, 0 );
+
+      std::size_t const mask = size - 1;
+
+      for ( id_type i = 0; i < m_hashes.size(); ++i )
+      {
+         std::size_t slot = m_hashes[ i ] & mask;
+
+         while ( 0 != m_slots[ slot ] )
+         {
+            slot = ( slot + 1 ) & mask;
+         }
+         m_slots[ slot ] = i + 1;
+      }
+   }
+
+   /**
+    * the characters of all words, back to back.
+    */
+   std::vector< char > m_pool;
+
+   /**
+    * the offset of each word in the pool, followed by the pool size.
+    */
+   std::vector< std::size_t > m_offsets;
+
+   /**
+    * the hash of each word.
+    */
+   std::vector< hash_type > m_hashes;
+
+   /**
+    * the hash table: word number plus one; 0 for a free slot.
+    */
+   std::vector< id_type > m_slots;
+};
+
+} // namespace wordindex
+
+#endif // dictionary_h_included
+
+/*
+ * end of file
+ */
@@ -0,0 +1,633 @@
+/*
+ * FileLoader.h - load many small files in batches.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef fileloader_h_included
+#define fileloader_h_included
+
+#include "Config.h"     // for _WORDINDEX_HAVE_IO_URING
+#include "MappedFile.h" // for file_size_type
+#include "Parallel.h"   // for hardware_threads(), run_parallel()
+#include "Utility.h"    // for class UnCopyable, to_charptr()
+
+#include <algorithm>    // for std::min(), std::find()
+#include <cerrno>       // for errno, ENOENT, EINVAL
+#include <cstddef>      // for std::size_t
+#include <string>       // for std::string
+#include <vector>       // for std::vector<>
+
+#ifdef _WIN32
+# include <fstream>     // for std::ifstream
+#else
+# include <fcntl.h>     // for open()
+# include <sys/stat.h>  // for fstat()
+# include <unistd.h>    // for read(), close()
+#endif
+
+#ifdef _WORDINDEX_HAVE_IO_URING
+# include <linux/io_uring.h>   // for struct io_uring_sqe etc.
+# include <sys/mman.h>         // for mmap()
+# include <sys/syscall.h>      // for syscall(), __NR_io_uring_setup etc.
+#endif
+
+namespace wordindex {
+
+/**
+ * the files up to this size are loaded by the file loader; larger ones are mapped.
+ */
+std::size_t const small_file_size = 1 << 16;
+
+/**
+ * a file as loaded by the file loader.
+ */
+struct LoadedFile
+{
+   /**
+    * constructor.
+    */
+   LoadedFile()
+   : error  ( 0 )
+   , regular( false )
+   , loaded ( false )
+   , size   ( 0 )
+   {
+      ;
+   }
+
+   /**
+    * begin of file contents.
+    */
+   char const* begin() const
+   {
+      return data.empty() ? NULL : &data[ 0 ];
+   }
+
+   /**
+    * end of file contents.
+    */
+   char const* end() const
+   {
+      return begin() + data.size();
+   }
+
+   int               error;    ///< errno of a failed stat, open or read; 0 if none
+   bool              regular;  ///< true if a regular file
+   bool              loaded;   ///< true if the contents are in data
+   file_size_type    size;     ///< the file size
+   std::vector< char > data;   ///< the file contents, if loaded
+};
+
+/**
+ * load the contents of the small regular files of a list into memory, with as
+ * few system calls per file as possible: opening a file checks that it exists.
+ * Through io_uring (Linux), the stats, opens, reads and closes of all files
+ * of a list are each submitted in one batch; otherwise, the files are loaded
+ * by a number of threads, each opening, reading and closing a share of them.
+ * Other files, such as larger files and pipes, are only examined.
+ */
+class FileLoader : private UnCopyable
+{
+public:
+   /**
+    * the list of loaded files type.
+    */
+   typedef std::vector< LoadedFile > files_type;
+
+   /**
+    * the maximum number of files per batch.
+    */
+   enum { batch_size = 256 };
+
+   /**
+    * constructor; use io_uring if available and not disabled.
+    */
+   explicit FileLoader( bool const use_io_uring = true )
+   : m_ring()
+   {
+      if ( use_io_uring )
+      {
+         m_ring.open( batch_size );
+      }
+   }
+
+   /**
+    * true if files are loaded through io_uring.
+    */
+   const bool uses_io_uring() const
+   {
+      return m_ring.is_open();
+   }
+
+   /**
+    * load the given files; a list longer than batch_size is loaded in parts.
+    */
+   void load( std::vector< std::string > const& filenames, files_type& files )
+   {
+      files.assign( filenames.size(), LoadedFile() );
+
+      for ( std::size_t first = 0; first < filenames.size(); first += batch_size )
+      {
+         std::size_t const last = std::min< std::size_t >( first + batch_size, filenames.size() );
+
+         if ( m_ring.is_open() && !m_ring.load( filenames, files, first, last ) )
+         {
+            m_ring.close();
+         }
+
+         if ( !m_ring.is_open() )
+         {
+            load_parallel( filenames, files, first, last );
+         }
+      }
+   }
+
+private:
+   /**
+    * load a file with ordinary system calls.
+    */
+   static void load_file( std::string const& filename, LoadedFile& file )
+   {
+#ifdef _WIN32
+      file.size    = file_size( filename );
+      file.regular = is_regular_file( filename );
+
+      if ( !file.regular || file.size > small_file_size )
+      {
+         file.error = exist( filename ) ? 0 : ENOENT;
+         return;
+      }
+
+      std::ifstream is( to_charptr( filename ), std::ios::binary );
+
+      file.data.resize( static_cast< std::size_t >( file.size ) );
+
+      if ( !is || ( file.size > 0 && !is.read( &file.data[ 0 ], file.data.size() ) ) )
+      {
+         file.error = ENOENT;
+         return;
+      }
+      file.loaded = true;
+#else
+      // do not wait for a writer when opening a pipe:
+      int const fd = ::open( to_charptr( filename ), O_RDONLY | O_NONBLOCK );
+
+      if ( fd < 0 )
+      {
+         file.error = errno;
+         return;
+      }
+
+      struct stat st;
+
+      if ( 0 == fstat( fd, &st ) )
+      {
+         file.regular = S_ISREG( st.st_mode );
+         file.size    = file.regular ? st.st_size : 0;
+
+         if ( file.regular && file.size <= small_file_size )
+         {
+            file.data.resize( static_cast< std::size_t >( file.size ) );
+            file.loaded = read_all( fd, file.data );
+         }
+      }
+
+      ::close( fd );
+#endif
+   }
+
+#ifndef _WIN32
+   /**
+    * read the given number of characters; false on error or early end of file.
+    */
+   static const bool read_all( int const fd, std::vector< char >& data )
+   {
+      for ( std::size_t done = 0; done < data.size(); )
+      {
+         ssize_t const n = ::read( fd, &data[ done ], data.size() - done );
+
+         if ( n <= 0 )
+         {
+            return false;
+         }
+         done += static_cast< std::size_t >( n );
+      }
+      return true;
+   }
+#endif
+
+   /**
+    * load every count-th file from first on, before last (thread function).
+    */
+   class Loader
+   {
+   public:
+      Loader( std::vector< std::string > const& filenames, files_type& files, std::size_t const first, std::size_t const last, std::size_t const count )
+      : m_filenames( &filenames ), m_files( &files ), m_first( first ), m_last( last ), m_count( count ) { ; }
+
+      void operator()()
+      {
+         for ( std::size_t i = m_first; i < m_last; i += m_count )
+         {
+            load_file( (*m_filenames)[ i ], (*m_files)[ i ] );
+         }
+      }
+
+   private:
+      std::vector< std::string > const* m_filenames;  ///< the files to load
+      files_type*  m_files;   ///< the loaded files
+      std::size_t  m_first;   ///< first file to load
+      std::size_t  m_last;    ///< end of files to load
+      std::size_t  m_count;   ///< number of loaders
+   };
+
+   /**
+    * load files [first, last) with as many threads as the hardware runs.
+    */
+   static void load_parallel( std::vector< std::string > const& filenames, files_type& files, std::size_t const first, std::size_t const last )
+   {
+      std::size_t const count = std::min< std::size_t >( hardware_threads(), last - first );
+
+      std::vector< Loader > loaders;
+
+      for ( std::size_t i = 0; i < count; ++i )
+      {
+         loaders.push_back( Loader( filenames, files, first + i, last, count ) );
+      }
+
+      if ( 1 == loaders.size() )
+      {
+         loaders[ 0 ]();
+      }
+      else
+      {
+         run_parallel( loaders );
+      }
+   }
+
+#ifdef _WORDINDEX_HAVE_IO_URING
+   /**
+    * an io_uring instance, used synchronously: each batch of operations is
+    * submitted and waited for with one system call.
+    */
+   class Ring : private UnCopyable
+   {
+   public:
+      Ring()
+      : m_fd( -1 ), m_sq( NULL ), m_sq_size( 0 ), m_cq( NULL ), m_cq_size( 0 ), m_sqes( NULL ), m_sqes_size( 0 ), m_proven( false ) { ; }
+
+      ~Ring()
+      {
+         close();
+      }
+
+      /**
+       * set up a ring for the given number of operations per batch; see
+       * is_open(). The ring is not used if the kernel does not support all
+       * operations used here, which arrived in Linux 5.6.
+       */
+      void open( unsigned int const entries )
+      {
+         io_uring_params params = io_uring_params();
+
+         m_fd = static_cast< int >( syscall( __NR_io_uring_setup, entries, &params ) );
+
+         if ( m_fd < 0 )
+         {
+            return;
+         }
+
+         m_params    = params;
+         m_sq_size   = params.sq_off.array + params.sq_entries * sizeof( unsigned int );
+         m_cq_size   = params.cq_off.cqes  + params.cq_entries * sizeof( io_uring_cqe );
+         m_sqes_size = params.sq_entries * sizeof( io_uring_sqe );
+
+         m_sq   = map( m_sq_size, IORING_OFF_SQ_RING );
+         m_cq   = map( m_cq_size, IORING_OFF_CQ_RING );
+         m_sqes = static_cast< io_uring_sqe* >( static_cast< void* >( map( m_sqes_size, IORING_OFF_SQES ) ) );
+
+         if ( NULL == m_sq || NULL == m_cq || NULL == m_sqes
+            || !supports( IORING_OP_STATX ) || !supports( IORING_OP_OPENAT ) || !supports( IORING_OP_READ ) || !supports( IORING_OP_CLOSE ) )
+         {
+            close();
+         }
+      }
+
+      /**
+       * unmap the ring areas and close the ring.
+       */
+      void close()
+      {
+         if ( m_sqes ) munmap( m_sqes, m_sqes_size );
+         if ( m_cq   ) munmap( m_cq  , m_cq_size   );
+         if ( m_sq   ) munmap( m_sq  , m_sq_size   );
+         if ( m_fd >= 0 ) ::close( m_fd );
+
+         m_fd = -1; m_sq = NULL; m_cq = NULL; m_sqes = NULL;
+      }
+
+      /**
+       * true if the ring has been set up.
+       */
+      const bool is_open() const
+      {
+         return m_fd >= 0;
+      }
+
+      /**
+       * load files [first, last): stat all, then open, read and close the
+       * small regular files. False, with nothing loaded, if the first stats
+       * are rejected as invalid: the kernel does not know the operations.
+       */
+      const bool load( std::vector< std::string > const& filenames, files_type& files, std::size_t const first, std::size_t const last )
+      {
+         std::size_t const n = last - first;
+
+         std::vector< struct statx > stats( n );
+         std::vector< int > results( n, 0 );
+         std::vector< int > fds( n, -1 );
+
+         // stat, which checks that the file exists:
+         for ( std::size_t i = 0; i < n; ++i )
+         {
+            io_uring_sqe& sqe = next_sqe( i );
+            sqe.opcode      = IORING_OP_STATX;
+            sqe.fd          = AT_FDCWD;
+            sqe.addr        = address( to_charptr( filenames[ first + i ] ) );
+            sqe.len         = STATX_TYPE | STATX_SIZE;
+            sqe.off         = address( &stats[ i ] );
+         }
+         submit_and_wait( n, results );
+
+         if ( !m_proven && results.end() != std::find( results.begin(), results.end(), -EINVAL ) )
+         {
+            return false;
+         }
+
+         m_proven = true;
+
+         std::vector< std::size_t > small;
+
+         for ( std::size_t i = 0; i < n; ++i )
+         {
+            LoadedFile& file = files[ first + i ];
+
+            if ( results[ i ] < 0 )
+            {
+               file.error = -results[ i ];
+               continue;
+            }
+
+            file.regular = S_ISREG( stats[ i ].stx_mode );
+            file.size    = file.regular ? stats[ i ].stx_size : 0;
+
+            if ( file.regular && file.size <= small_file_size )
+            {
+               file.data.resize( static_cast< std::size_t >( file.size ) );
+               file.loaded = 0 == file.size;
+
+               if ( file.size > 0 )
+               {
+                  small.push_back( i );
+               }
+            }
+         }
+
+         // open:
+         for ( std::size_t k = 0; k < small.size(); ++k )
+         {
+            io_uring_sqe& sqe = next_sqe( k );
+            sqe.opcode      = IORING_OP_OPENAT;
+            sqe.fd          = AT_FDCWD;
+            sqe.addr        = address( to_charptr( filenames[ first + small[ k ] ] ) );
+            sqe.open_flags  = O_RDONLY | O_CLOEXEC;
+         }
+         submit_and_wait( small.size(), results );
+
+         std::vector< std::size_t > opened;
+
+         for ( std::size_t k = 0; k < small.size(); ++k )
+         {
+            if ( results[ k ] < 0 )
+            {
+               files[ first + small[ k ] ].error = -results[ k ];
+            }
+            else
+            {
+               fds[ small[ k ] ] = results[ k ];
+               opened.push_back( small[ k ] );
+            }
+         }
+
+         // read:
+         for ( std::size_t k = 0; k < opened.size(); ++k )
+         {
+            LoadedFile& file = files[ first + opened[ k ] ];
+
+            io_uring_sqe& sqe = next_sqe( k );
+            sqe.opcode      = IORING_OP_READ;
+            sqe.fd          = fds[ opened[ k ] ];
+            sqe.addr        = address( &file.data[ 0 ] );
+            sqe.len         = static_cast< unsigned int >( file.data.size() );
+            sqe.off         = 0;
+         }
+         submit_and_wait( opened.size(), results );
+
+         for ( std::size_t k = 0; k < opened.size(); ++k )
+         {
+            LoadedFile& file = files[ first + opened[ k ] ];
+
+            // a short read leaves the file to be read otherwise:
+            file.loaded = results[ k ] == static_cast< int >( file.data.size() );
+         }
+
+         // close:
+         for ( std::size_t k = 0; k < opened.size(); ++k )
+         {
+            io_uring_sqe& sqe = next_sqe( k );
+            sqe.opcode      = IORING_OP_CLOSE;
+            sqe.fd          = fds[ opened[ k ] ];
+         }
+         submit_and_wait( opened.size(), results );
+
+         return true;
+      }
+
+   private:
+      /**
+       * true if the kernel supports the given operation; probing is itself
+       * an operation of Linux 5.6, so older kernels support none.
+       */
+      const bool supports( unsigned int const opcode ) const
+      {
+         std::vector< unsigned char > buffer( sizeof( io_uring_probe ) + probe_size * sizeof( io_uring_probe_op ) );
+         io_uring_probe* const probe = static_cast< io_uring_probe* >( static_cast< void* >( &buffer[ 0 ] ) );
+
+         if ( syscall( __NR_io_uring_register, m_fd, IORING_REGISTER_PROBE, probe, probe_size ) < 0 )
+         {
+            return false;
+         }
+
+         return opcode < probe->ops_len && 0 != ( probe->ops[ opcode ].flags & IO_URING_OP_SUPPORTED );
+      }
+
+      /**
+       * number of operations probed.
+       */
+      enum { probe_size = 256 };
+
+      /**
+       * map a ring area.
+       */
+      unsigned char* map( std::size_t const size, unsigned long long const offset )
+      {
+         void* const area = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, offset );
+
+         return MAP_FAILED == area ? NULL : static_cast< unsigned char* >( area );
+      }
+
+      /**
+       * the given submission queue field.
+       */
+      unsigned int* sq_field( unsigned int const offset ) const
+      {
+         return static_cast< unsigned int* >( static_cast< void* >( m_sq + offset ) );
+      }
+
+      /**
+       * the given completion queue field.
+       */
+      unsigned int* cq_field( unsigned int const offset ) const
+      {
+         return static_cast< unsigned int* >( static_cast< void* >( m_cq + offset ) );
+      }
+
+      /**
+       * the cleared submission queue entry for the operation with the given number.
+       */
+      io_uring_sqe& next_sqe( std::size_t const number )
+      {
+         unsigned int const tail  = *sq_field( m_params.sq_off.tail ) + static_cast< unsigned int >( number );
+         unsigned int const index = tail & *sq_field( m_params.sq_off.ring_mask );
+
+         io_uring_sqe& sqe = m_sqes[ index ];
+         sqe = io_uring_sqe();
+         sqe.user_data = number;
+
+         sq_field( m_params.sq_off.array )[ index ] = index;
+         return sqe;
+      }
+
+      /**
+       * submit the given number of prepared operations, wait for them to
+       * complete and store their results by operation number.
+       */
+      void submit_and_wait( std::size_t const count, std::vector< int >& results )
+      {
+         if ( 0 == count )
+         {
+            return;
+         }
+
+         unsigned int* const sq_tail = sq_field( m_params.sq_off.tail );
+         __atomic_store_n( sq_tail, *sq_tail + static_cast< unsigned int >( count ), __ATOMIC_RELEASE );
+
+         std::size_t done = 0;
+
+         while ( done < count )
+         {
+            unsigned int const submit = 0 == done ? static_cast< unsigned int >( count ) : 0;
+
+            if ( syscall( __NR_io_uring_enter, m_fd, submit, static_cast< unsigned int >( count - done ), IORING_ENTER_GETEVENTS, NULL, 0 ) < 0 && EINTR != errno )
+            {
+               // cannot happen for a ring set up properly; report all as failed:
+               for ( std::size_t i = 0; i < count; ++i ) results[ i ] = -EIO;
+               return;
+            }
+
+            unsigned int* const cq_head = cq_field( m_params.cq_off.head );
+            unsigned int const  cq_tail = __atomic_load_n( cq_field( m_params.cq_off.tail ), __ATOMIC_ACQUIRE );
+            unsigned int const  mask    = *cq_field( m_params.cq_off.ring_mask );
+
+            io_uring_cqe const* const cqes = static_cast< io_uring_cqe const* >( static_cast< void const* >( m_cq + m_params.cq_off.cqes ) );
+
+            unsigned int head = *cq_head;
+
+            for ( ; head != cq_tail; ++head, ++done )
+            {
+               io_uring_cqe const& cqe = cqes[ head & mask ];
+               results[ static_cast< std::size_t >( cqe.user_data ) ] = cqe.res;
+            }
+
+            __atomic_store_n( cq_head, head, __ATOMIC_RELEASE );
+         }
+      }
+
+      /**
+       * the given pointer as ring address.
+       */
+      static unsigned long long address( void const* pointer )
+      {
+         return reinterpret_cast< unsigned long long >( pointer );
+      }
+
+      int              m_fd;         ///< the ring
+      io_uring_params  m_params;     ///< the ring parameters (offsets)
+      unsigned char*   m_sq;         ///< the submission queue ring
+      std::size_t      m_sq_size;    ///< its size
+      unsigned char*   m_cq;         ///< the completion queue ring
+      std::size_t      m_cq_size;    ///< its size
+      io_uring_sqe*    m_sqes;       ///< the submission queue entries
+      std::size_t      m_sqes_size;  ///< their size
+      bool             m_proven;     ///< true once a batch has been stat'ed
+   };
+#else
+   /**
+    * no io_uring: a ring that never opens.
+    */
+   class Ring
+   {
+   public:
+      void open( unsigned int const entries ) { ; }
+      void close() { ; }
+      const bool is_open() const { return false; }
+      const bool load( std::vector< std::string > const& filenames, files_type& files, std::size_t const first, std::size_t const last ) { return false; }
+   };
+#endif
+
+   /**
+    * the io_uring instance, if used.
+    */
+   Ring m_ring;
+};
+
+} // namespace wordindex
+
+#endif // fileloader_h_included
+
+/*
+ * end of file
+ */
@@ -0,0 +1,82 @@
+/*
+ * Hash.h - token hash function.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef hash_h_included
+#define hash_h_included
+
+#include <string>    // for std::string
+
+namespace wordindex {
+
+/**
+ * the hash value type.
+ */
+typedef unsigned long long hash_type;
+
+/**
+ * the hash of an empty token (FNV-1a offset basis).
+ */
+hash_type const hash_basis = 14695981039346656037ULL;
+
+/**
+ * add a character to a running hash (64-bit FNV-1a); usable in constant expressions.
+ */
+constexpr hash_type hash_add( hash_type const hash, char const chr )
+{
+   return ( hash ^ static_cast< unsigned char >( chr ) ) * 1099511628211ULL;
+}
+
+/**
+ * the hash of the characters in [first, last).
+ */
+inline const hash_type hash_bytes( char const* first, char const* last )
+{
+   hash_type hash = hash_basis;
+
+   for ( ; first != last; ++first )
+   {
+      hash = hash_add( hash, *first );
+   }
+   return hash;
+}
+
+/**
+ * the hash of the given string.
+ */
+inline const hash_type hash_string( std::string const& s )
+{
+   return hash_bytes( s.data(), s.data() + s.size() );
+}
+
+} // namespace wordindex
+
+#endif // hash_h_included
+
+/*
+ * end of file
+ */
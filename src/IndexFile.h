@@ -0,0 +1,1188 @@
+/*
+ * IndexFile.h - word index saved as memory-mappable file, and its builder.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef indexfile_h_included
+#define indexfile_h_included
+
+#include "Dictionary.h"    // for class Dictionary
+#include "Hash.h"          // for hash_type, hash_bytes()
+#include "MappedFile.h"    // for class MappedFile, file_size(), file_time()
+#include "OutputBuffer.h"  // for class OutputBuffer
+#include "Postings.h"      // for class Postings, class PostingsView
+#include "Query.h"         // for location()
+#include "TokenView.h"     // for class TokenView
+#include "Utility.h"       // for class UnCopyable, to_charptr()
+#include "WordIndex.h"     // for class WordIndex
+#include "WordTrie.h"      // for class WordTrie
+
+#include <algorithm>       // for std::sort(), std::stable_sort(), std::adjacent_find()
+#include <cstring>         // for std::memcmp(), std::memcpy(), std::memset()
+#include <fstream>         // for std::ifstream
+#include <iterator>        // for std::forward_iterator_tag
+#include <ostream>         // for std::ostream
+#include <string>          // for std::string
+#include <vector>          // for std::vector<>
+
+namespace wordindex {
+
+/**
+ * an input file as recorded in an index file.
+ */
+struct IndexedFile
+{
+   /**
+    * default constructor.
+    */
+   IndexedFile()
+   : size( 0 )
+   , time( 0 )
+   , hash( 0 )
+   {
+      ;
+   }
+
+   /**
+    * constructor; the given file as it is now, with its contents not yet hashed.
+    */
+   explicit IndexedFile( std::string const& filename )
+   : name( filename )
+   , size( file_size( filename ) )
+   , time( file_time( filename ) )
+   , hash( 0 )
+   {
+      ;
+   }
+
+   std::string    name;    ///< the filename as given
+   file_size_type size;    ///< the file size
+   file_time_type time;    ///< the file modification time
+   hash_type      hash;    ///< the hash of the file contents, see hash_bytes(); 0 if not a regular file
+};
+
+class IndexBuilder;
+
+/**
+ * word index saved as file that is used directly from memory once mapped,
+ * so that it can be printed without reading any text:
+ *
+ *   header   magic "WIIX", format version, byte order mark, flags, and the
+ *            numbers of words, segment record bytes, files, keywords,
+ *            references, characters, postings bytes and filename
+ *            characters, the signature of the options the index was made
+ *            with, the numbers of trie nodes and trie characters, and the
+ *            time the index was started
+ *   words    words + 1 offsets of the words in chars, in word order
+ *   counts   words occurrence counts
+ *   postings words + 1 offsets of the line numbers of the words in lines
+ *   segments words + 1 offsets of the segment records of the words in records
+ *   files    per file its size, modification time and contents hash, and
+ *            files + 1 offsets of the filenames in names
+ *   trie     the numbers of the nodes of the trie of the words, see class
+ *            WordTrie, as 32-bit numbers
+ *   chars    the characters of the words
+ *   lines    the line numbers of the words, encoded as by class Postings
+ *   records  per word, a segment record per file it occurs in: the file
+ *            number less that of the previous segment, and the occurrence
+ *            count, encoded as by encode_number()
+ *   names    the characters of the filenames
+ *   labels   the characters of the labels of the trie nodes
+ *
+ * The line numbers of a word are divided in segments, one per file it occurs
+ * in, in file order, so that the index can be updated file by file, see
+ * class IndexBuilder; a segment holds as many line numbers as its record
+ * counts. Offsets, counts and sizes are 64-bit numbers, stored in the byte
+ * order of the machine that wrote the file; a file written on a machine with
+ * another byte order is rejected.
+ */
+class IndexFile : private UnCopyable
+{
+public:
+   /**
+    * the offset, count and size type.
+    */
+   typedef unsigned long long offset_type;
+
+   /**
+    * the occurrence count type.
+    */
+   typedef WordIndex::count_type count_type;
+
+   /**
+    * the size type.
+    */
+   typedef std::size_t size_type;
+
+   /**
+    * the word type: a view into the mapped file.
+    */
+   typedef TokenView word_type;
+
+   /**
+    * the list of indexed files type.
+    */
+   typedef std::vector< IndexedFile > files_type;
+
+   /**
+    * the format version.
+    */
+   enum { version = 5 };
+
+   /**
+    * this value type: a word with its line numbers and number of occurrences.
+    */
+   struct value_type
+   {
+      /**
+       * constructor.
+       */
+      value_type( word_type const& word, PostingsView const& lines, count_type const n )
+      : first ( word  )
+      , second( lines )
+      , count ( n     )
+      {
+         ;
+      }
+
+      word_type    first;   ///< the word
+      PostingsView second;  ///< the word's line numbers; empty when only counting
+      count_type   count;   ///< the word's number of occurrences
+   };
+
+   /**
+    * const iterator over the words in word order.
+    */
+   class const_iterator
+   {
+   public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef IndexFile::value_type     value_type;
+      typedef std::ptrdiff_t            difference_type;
+      typedef value_type const*         pointer;
+      typedef value_type                reference;
+
+      /**
+       * default constructor.
+       */
+      const_iterator()
+      : m_pos( 0 )
+      , m_index( NULL )
+      {
+      }
+
+      /**
+       * constructor.
+       */
+      const_iterator( size_type const pos, IndexFile const* index )
+      : m_pos( pos )
+      , m_index( index )
+      {
+      }
+
+      /**
+       * the number of the current word (position in word order).
+       */
+      const size_type position() const
+      {
+         return m_pos;
+      }
+
+      /**
+       * the current entry.
+       */
+      reference operator*() const
+      {
+         return m_index->entry( m_pos );
+      }
+
+      /**
+       * advance to next entry.
+       */
+      const_iterator& operator++()
+      {
+         ++m_pos;
+         return *this;
+      }
+
+      /**
+       * advance to next entry.
+       */
+      const_iterator operator++( int )
+      {
+         const_iterator result( *this );
+         ++m_pos;
+         return result;
+      }
+
+      /**
+       * advance the given number of entries.
+       */
+      const_iterator& operator+=( difference_type const n )
+      {
+         m_pos += n;
+         return *this;
+      }
+
+      /**
+       * true if this and other iterators are equal.
+       */
+      const bool operator==( const_iterator const& rhs ) const
+      {
+         return m_pos == rhs.m_pos;
+      }
+
+      /**
+       * true if this and other iterators are unequal.
+       */
+      const bool operator!=( const_iterator const& rhs ) const
+      {
+         return m_pos != rhs.m_pos;
+      }
+
+   private:
+      size_type        m_pos;     ///< the word number
+      IndexFile const* m_index;   ///< the index
+   };
+
+   /**
+    * constructor; map the given file, see is_open().
+    */
+   explicit IndexFile( std::string const& filename )
+   : m_file( filename )
+   , m_header( NULL )
+   , m_word_offsets( NULL )
+   , m_counts( NULL )
+   , m_postings_offsets( NULL )
+   , m_segment_offsets( NULL )
+   , m_chars( NULL )
+   , m_lines( NULL )
+   , m_records( NULL )
+   , m_open( false )
+   {
+      open();
+   }
+
+   /**
+    * true if the given file starts like an index file.
+    */
+   static const bool is_index_file( std::string const& filename )
+   {
+      std::ifstream is( to_charptr( filename ), std::ios::binary );
+
+      char header[ magic_size ] = { 0 };
+
+      return is.read( header, magic_size ) && 0 == std::memcmp( header, magic(), magic_size );
+   }
+
+   /**
+    * true if the file is a valid index file of this version and byte order.
+    */
+   const bool is_open() const
+   {
+      return m_open;
+   }
+
+   /**
+    * true if the index only counts words, without line numbers.
+    */
+   const bool count_only() const
+   {
+      return 0 != ( m_header->flags & flag_count_only );
+   }
+
+   /**
+    * the signature of the options the index was made with, see IndexBuilder.
+    */
+   const offset_type signature() const
+   {
+      return m_header->signature;
+   }
+
+   /**
+    * the time the index was started, before its files were read, see
+    * IndexBuilder::set_started().
+    */
+   const file_time_type started() const
+   {
+      return static_cast< file_time_type >( m_header->started );
+   }
+
+   /**
+    * number of distinct words.
+    */
+   const size_type words() const
+   {
+      return static_cast< size_type >( m_header->words );
+   }
+
+   /**
+    * number of line references.
+    */
+   const count_type lines() const
+   {
+      return m_header->lines;
+   }
+
+   /**
+    * number of keywords in use when the index was made.
+    */
+   const size_type keywords() const
+   {
+      return static_cast< size_type >( m_header->keywords );
+   }
+
+   /**
+    * the indexed files.
+    */
+   files_type const& files() const
+   {
+      return m_files;
+   }
+
+   /**
+    * const begin iterator.
+    */
+   const_iterator begin() const
+   {
+      return const_iterator( 0, this );
+   }
+
+   /**
+    * const end iterator.
+    */
+   const_iterator end() const
+   {
+      return const_iterator( words(), this );
+   }
+
+   /**
+    * the given word; end() if not present (binary search in word order).
+    */
+   const_iterator find( std::string const& word ) const
+   {
+      word_type const key( word.data(), word.data() + word.size() );
+
+      size_type first = 0;
+      size_type count = words();
+
+      while ( count > 0 )
+      {
+         size_type const half = count / 2;
+
+         if ( this->word( first + half ) < key )
+         {
+            first += half + 1;
+            count -= half + 1;
+         }
+         else
+         {
+            count = half;
+         }
+      }
+
+      return first < words() && this->word( first ) == key ? const_iterator( first, this ) : end();
+   }
+
+   /**
+    * the trie of the words, for prefix and wildcard lookups by word number.
+    */
+   WordTrie const& trie() const
+   {
+      return m_trie;
+   }
+
+   /**
+    * append the locations of the given word to result, in (file, line) order;
+    * none if the word is not present or the index only counts words.
+    */
+   void locations( std::string const& word, locations_type& result ) const
+   {
+      const_iterator const pos = find( word );
+
+      if ( pos == end() )
+      {
+         return;
+      }
+
+      Segments segments( *this, pos.position() );
+
+      PostingsView::const_iterator line = segments.lines().begin();
+      PostingsView::const_iterator const last = segments.lines().end();
+
+      while ( segments.next() )
+      {
+         for ( count_type i = 0; i < segments.count() && line != last; ++i, ++line )
+         {
+            result.push_back( location( static_cast< std::size_t >( segments.file() ), *line ) );
+         }
+      }
+   }
+
+   /**
+    * the entry of the word with the given number (position in word order); the
+    * entry of a damaged file may come out empty, but never lies outside the file.
+    */
+   value_type entry( size_type const n ) const
+   {
+      offset_type lines_first = 0, lines_last = 0;
+
+      range( m_postings_offsets, n, m_header->postings, lines_first, lines_last );
+
+      return value_type
+      ( word( n )
+      , PostingsView( m_lines + lines_first, m_lines + lines_last, lines_last > lines_first ? m_counts[ n ] : 0 )
+      , m_counts[ n ]
+      );
+   }
+
+private:
+   friend class IndexBuilder;
+
+   /**
+    * the value of Header::byte_order in the writer's byte order; the size of the magic.
+    */
+   enum { byte_order_mark = 0x01020304, magic_size = 4 };
+
+   /**
+    * Header::flags: the index only counts words.
+    */
+   enum { flag_count_only = 1 };
+
+   /**
+    * the segment records of a word, decoded one by one.
+    */
+   class Segments
+   {
+   public:
+      /**
+       * constructor; the segments of the word with the given number.
+       */
+      Segments( IndexFile const& index, size_type const n )
+      : m_pos( NULL )
+      , m_end( NULL )
+      , m_file( 0 )
+      , m_count( 0 )
+      {
+         offset_type first = 0, last = 0;
+
+         range( index.m_segment_offsets, n, index.m_header->segments, first, last );
+
+         m_pos = index.m_records + first;
+         m_end = index.m_records + last;
+
+         range( index.m_postings_offsets, n, index.m_header->postings, first, last );
+
+         m_lines = PostingsView( index.m_lines + first, index.m_lines + last, last > first ? index.m_counts[ n ] : 0 );
+      }
+
+      /**
+       * advance to the next segment; false if there is none or it is damaged.
+       */
+      const bool next()
+      {
+         offset_type step = 0;
+
+         if ( m_pos == m_end || !decode_number( m_pos, m_end, step ) || !decode_number( m_pos, m_end, m_count ) )
+         {
+            m_pos = m_end;
+            return false;
+         }
+
+         m_file += step;
+         return true;
+      }
+
+      /**
+       * the file number of the current segment.
+       */
+      const offset_type file() const
+      {
+         return m_file;
+      }
+
+      /**
+       * the number of occurrences in the current segment.
+       */
+      const count_type count() const
+      {
+         return m_count;
+      }
+
+      /**
+       * the line numbers of all segments of the word; empty when only counting.
+       */
+      PostingsView const& lines() const
+      {
+         return m_lines;
+      }
+
+   private:
+      PostingsView::byte_type const* m_pos;    ///< the next record
+      PostingsView::byte_type const* m_end;    ///< the end of the records
+      offset_type                    m_file;   ///< the current file number
+      count_type                     m_count;  ///< the current occurrence count
+      PostingsView                   m_lines;  ///< the word's line numbers
+   };
+
+   /**
+    * the file header; its size keeps the offsets that follow 8-byte aligned.
+    */
+   struct Header
+   {
+      char         magic[ magic_size ]; ///< see magic()
+      unsigned int version;     ///< format version
+      unsigned int byte_order;  ///< byte_order_mark as written
+      unsigned int flags;       ///< see flag_count_only
+      offset_type  words;       ///< number of words
+      offset_type  segments;    ///< number of bytes of the segment records
+      offset_type  files;       ///< number of indexed files
+      offset_type  keywords;    ///< number of keywords in use
+      offset_type  lines;       ///< number of line references
+      offset_type  chars;       ///< number of characters of the words
+      offset_type  postings;    ///< number of bytes of the line numbers
+      offset_type  names;       ///< number of characters of the filenames
+      offset_type  signature;   ///< signature of the options in use
+      offset_type  trie_nodes;  ///< number of nodes of the trie of the words
+      offset_type  trie_chars;  ///< number of characters of the trie labels
+      offset_type  started;     ///< the time the index was started
+   };
+
+   /**
+    * the file magic.
+    */
+   static char const* magic()
+   {
+      return "WIIX";
+   }
+
+   /**
+    * the word with the given number.
+    */
+   word_type word( size_type const n ) const
+   {
+      offset_type first = 0, last = 0;
+
+      range( m_word_offsets, n, m_header->chars, first, last );
+
+      return word_type( m_chars + first, m_chars + last );
+   }
+
+   /**
+    * the range [first, last) of entry n from the given offsets; empty if it
+    * lies outside [0, limit).
+    */
+   static void range( offset_type const* offsets, size_type const n, offset_type const limit, offset_type& first, offset_type& last )
+   {
+      first = offsets[ n ];
+      last  = offsets[ n + 1 ];
+
+      if ( first > last || last > limit )
+      {
+         first = last = 0;
+      }
+   }
+
+   /**
+    * validate the mapped file and set up the sections. Only the structure is
+    * checked here, so that opening takes no time; entries are checked as read.
+    */
+   void open()
+   {
+      if ( !m_file.is_open() || m_file.size() < sizeof( Header ) )
+      {
+         return;
+      }
+
+      Header const& header = *reinterpret_cast< Header const* >( m_file.begin() );
+
+      if ( 0 != std::memcmp( header.magic, magic(), magic_size )
+         || version != header.version || byte_order_mark != header.byte_order
+         || 0 != ( header.flags & ~flag_count_only ) )
+      {
+         return;
+      }
+
+      // bound the counts before computing sizes from them:
+      offset_type const size = m_file.size();
+
+      if ( header.words > size / sizeof( offset_type ) || header.files > size / sizeof( offset_type )
+         || header.chars > size || header.postings > size || header.segments > size || header.names > size
+         || header.words > static_cast< WordTrie::size_type >( -1 ) || header.trie_nodes > size / ( 4 * sizeof( WordTrie::size_type ) ) || header.trie_chars > size )
+      {
+         return;
+      }
+
+      offset_type const fixed =
+         sizeof( Header )
+         + ( 4 * header.words + 3 ) * sizeof( offset_type )
+         + ( 4 * header.files + 1 ) * sizeof( offset_type )
+         + WordTrie::numbers_size( static_cast< WordTrie::size_type >( header.trie_nodes ) ) * sizeof( WordTrie::size_type );
+
+      if ( size != fixed + header.chars + header.postings + header.segments + header.names + header.trie_chars )
+      {
+         return;
+      }
+
+      offset_type const* pos = reinterpret_cast< offset_type const* >( m_file.begin() + sizeof( Header ) );
+
+      m_word_offsets     = pos; pos += header.words + 1;
+      m_counts           = pos; pos += header.words;
+      m_postings_offsets = pos; pos += header.words + 1;
+      m_segment_offsets  = pos; pos += header.words + 1;
+
+      offset_type const* const sizes        = pos; pos += header.files;
+      offset_type const* const times        = pos; pos += header.files;
+      offset_type const* const hashes       = pos; pos += header.files;
+      offset_type const* const name_offsets = pos; pos += header.files + 1;
+
+      WordTrie::size_type const* const trie = reinterpret_cast< WordTrie::size_type const* >( pos );
+
+      m_chars = reinterpret_cast< char const* >( trie + WordTrie::numbers_size( static_cast< WordTrie::size_type >( header.trie_nodes ) ) );
+      m_lines   = reinterpret_cast< PostingsView::byte_type const* >( m_chars + header.chars );
+      m_records = m_lines + header.postings;
+
+      char const* const names  = m_chars + header.chars + header.postings + header.segments;
+      char const* const labels = names + header.names;
+
+      if ( 0 != m_word_offsets[ 0 ] || header.chars != m_word_offsets[ header.words ]
+         || 0 != m_postings_offsets[ 0 ] || header.postings != m_postings_offsets[ header.words ]
+         || 0 != m_segment_offsets[ 0 ] || header.segments != m_segment_offsets[ header.words ]
+         || 0 != name_offsets[ 0 ] || header.names != name_offsets[ header.files ]
+         || !m_trie.attach( static_cast< WordTrie::size_type >( header.trie_nodes ), trie, labels, header.trie_chars, static_cast< WordTrie::size_type >( header.words ) ) )
+      {
+         return;
+      }
+
+      for ( offset_type i = 0; i < header.files; ++i )
+      {
+         if ( name_offsets[ i ] > name_offsets[ i + 1 ] )
+         {
+            return;
+         }
+
+         IndexedFile file;
+         file.name.assign( names + name_offsets[ i ], names + name_offsets[ i + 1 ] );
+         file.size = sizes[ i ];
+         file.time = static_cast< file_time_type >( times[ i ] );
+         file.hash = hashes[ i ];
+
+         m_files.push_back( file );
+      }
+
+      m_header = &header;
+      m_open   = true;
+   }
+
+   MappedFile         m_file;              ///< the mapped file
+   Header const*      m_header;            ///< the header
+   offset_type const* m_word_offsets;      ///< the offsets of the words in m_chars
+   offset_type const* m_counts;            ///< the occurrence counts of the words
+   offset_type const* m_postings_offsets;  ///< the offsets of the line numbers of the words in m_lines
+   offset_type const* m_segment_offsets;   ///< the offsets of the segment records of the words in m_records
+   char const*        m_chars;             ///< the characters of the words
+   PostingsView::byte_type const* m_lines; ///< the encoded line numbers of the words
+   PostingsView::byte_type const* m_records; ///< the encoded segment records of the words
+   files_type         m_files;             ///< the indexed files
+   WordTrie           m_trie;              ///< the trie of the words
+   bool               m_open;              ///< true if the file is valid
+};
+
+/**
+ * collect the words of an index file to be file by file, each from the word
+ * index of a file just read or from the segments of a file in an earlier
+ * index file, and write the index file. Words and files are given a number
+ * in order of arrival; the line numbers of the files of a word are appended
+ * to one list, with a record of each file and its number of occurrences,
+ * and are put in file order when the index file is written.
+ */
+class IndexBuilder : private UnCopyable
+{
+public:
+   /**
+    * the offset, count and size type.
+    */
+   typedef IndexFile::offset_type offset_type;
+
+   /**
+    * the occurrence count type.
+    */
+   typedef IndexFile::count_type count_type;
+
+   /**
+    * the size type.
+    */
+   typedef std::size_t size_type;
+
+   /**
+    * the list of indexed files type.
+    */
+   typedef IndexFile::files_type files_type;
+
+   /**
+    * the file number that stands for no file.
+    */
+   static size_type const npos = ~static_cast< size_type >( 0 );
+
+   /**
+    * constructor; the index counts words only or also collects line numbers,
+    * is made with the given number of keywords and with options of the given
+    * signature; an index file can only be updated with the same signature.
+    */
+   IndexBuilder( bool const count_only, size_type const keywords, offset_type const signature )
+   : m_count_only( count_only )
+   , m_keywords( keywords )
+   , m_signature( signature )
+   , m_started( 0 )
+   {
+      ;
+   }
+
+   /**
+    * set the time the index is started, before its files are read, in the
+    * clock of the file modification times: a file modified since may carry
+    * a time that is not later than recorded, unless it was earlier than this.
+    */
+   void set_started( file_time_type const time )
+   {
+      m_started = time;
+   }
+
+   /**
+    * the files.
+    */
+   files_type const& files() const
+   {
+      return m_files;
+   }
+
+   /**
+    * add a file; return its number.
+    */
+   const size_type add_file( IndexedFile const& file )
+   {
+      m_files.push_back( file );
+      return m_files.size() - 1;
+   }
+
+   /**
+    * add the words read from the file with the given number.
+    */
+   void add( size_type const file, WordIndex const& index )
+   {
+      for ( WordIndex::const_iterator pos = index.begin(); pos != index.end(); ++pos )
+      {
+         WordIndex::value_type const value = *pos;
+
+         id_type const id = add_segment( value.first, file, value.count );
+
+         if ( !m_count_only )
+         {
+            m_lines[ id ].append( value.second );
+         }
+      }
+   }
+
+   /**
+    * add the words of files of an earlier index file: its file n becomes file
+    * numbers[n] of this index, or is left out if that is npos.
+    */
+   void add( IndexFile const& index, std::vector< size_type > const& numbers )
+   {
+      for ( size_type n = 0; n < index.words(); ++n )
+      {
+         IndexFile::word_type const word = index.word( n );
+         IndexFile::Segments segments( index, n );
+
+         PostingsView::const_iterator line = segments.lines().begin();
+         PostingsView::const_iterator const last = segments.lines().end();
+
+         while ( segments.next() )
+         {
+            offset_type const file  = segments.file();
+            count_type  const count = segments.count();
+
+            bool const kept = file < numbers.size() && npos != numbers[ file ];
+
+            Postings* lines = NULL;
+
+            if ( kept )
+            {
+               id_type const id = add_segment( word, numbers[ file ], count );
+               lines = &m_lines[ id ];
+            }
+
+            // the line numbers of a file left out are passed over:
+            for ( count_type i = 0; i < count && line != last; ++i, ++line )
+            {
+               if ( kept && !m_count_only )
+               {
+                  lines->push_back( *line );
+               }
+            }
+         }
+      }
+   }
+
+   /**
+    * write the index file.
+    */
+   void write( std::ostream& os )
+   {
+      sort();
+
+      IndexFile::Header header;
+
+      std::memset( &header, 0, sizeof header );
+      std::memcpy( header.magic, IndexFile::magic(), IndexFile::magic_size );
+      header.version    = IndexFile::version;
+      header.byte_order = IndexFile::byte_order_mark;
+      header.flags      = m_count_only ? IndexFile::flag_count_only : 0;
+      header.words      = m_order.size();
+      header.files      = m_files.size();
+      header.keywords   = m_keywords;
+      header.signature  = m_signature;
+      header.started    = static_cast< offset_type >( m_started );
+
+      /*
+       * the segment records, with the file numbers relative to the previous:
+       */
+      std::vector< offset_type > counts;
+      std::vector< offset_type > record_offsets( 1, 0 );
+      std::vector< Postings::byte_type > records;
+      std::vector< Segment > segments;
+
+      for ( std::vector< id_type >::const_iterator id = m_order.begin(); id != m_order.end(); ++id )
+      {
+         decode( m_records[ *id ], segments );
+
+         size_type file = 0;
+         count_type count = 0;
+
+         for ( std::vector< Segment >::const_iterator pos = segments.begin(); pos != segments.end(); ++pos )
+         {
+            encode_number( records, pos->file - file );
+            encode_number( records, pos->count );
+
+            file   = pos->file;
+            count += pos->count;
+         }
+
+         counts.push_back( count );
+         record_offsets.push_back( records.size() );
+
+         header.lines    += count;
+         header.chars    += m_words.word( *id ).size();
+         header.postings += m_lines[ *id ].encoded_size();
+      }
+
+      header.segments = records.size();
+
+      for ( files_type::const_iterator pos = m_files.begin(); pos != m_files.end(); ++pos )
+      {
+         header.names += pos->name.size();
+      }
+
+      std::vector< TokenView > words;
+
+      for ( std::vector< id_type >::const_iterator id = m_order.begin(); id != m_order.end(); ++id )
+      {
+         words.push_back( m_words.word( *id ) );
+      }
+
+      WordTrie trie;
+      trie.assign( words );
+
+      header.trie_nodes = trie.nodes();
+      header.trie_chars = trie.chars_size();
+
+      OutputBuffer out( os );
+
+      out.write( reinterpret_cast< char const* >( &header ), reinterpret_cast< char const* >( &header + 1 ) );
+
+      /*
+       * words, counts, postings and segment offsets:
+       */
+      offset_type offset = 0;
+      put( out, offset );
+
+      for ( std::vector< id_type >::const_iterator id = m_order.begin(); id != m_order.end(); ++id )
+      {
+         put( out, offset += m_words.word( *id ).size() );
+      }
+
+      for ( std::vector< offset_type >::const_iterator pos = counts.begin(); pos != counts.end(); ++pos )
+      {
+         put( out, *pos );
+      }
+
+      put( out, offset = 0 );
+
+      for ( std::vector< id_type >::const_iterator id = m_order.begin(); id != m_order.end(); ++id )
+      {
+         put( out, offset += m_lines[ *id ].encoded_size() );
+      }
+
+      for ( std::vector< offset_type >::const_iterator pos = record_offsets.begin(); pos != record_offsets.end(); ++pos )
+      {
+         put( out, *pos );
+      }
+
+      /*
+       * files:
+       */
+      for ( files_type::const_iterator pos = m_files.begin(); pos != m_files.end(); ++pos )
+      {
+         put( out, pos->size );
+      }
+
+      for ( files_type::const_iterator pos = m_files.begin(); pos != m_files.end(); ++pos )
+      {
+         put( out, static_cast< offset_type >( pos->time ) );
+      }
+
+      for ( files_type::const_iterator pos = m_files.begin(); pos != m_files.end(); ++pos )
+      {
+         put( out, pos->hash );
+      }
+
+      put( out, offset = 0 );
+
+      for ( files_type::const_iterator pos = m_files.begin(); pos != m_files.end(); ++pos )
+      {
+         put( out, offset += pos->name.size() );
+      }
+
+      /*
+       * trie nodes:
+       */
+      char const* const numbers = reinterpret_cast< char const* >( trie.numbers() );
+      out.write( numbers, numbers + WordTrie::numbers_size( trie.nodes() ) * sizeof( WordTrie::size_type ) );
+
+      /*
+       * characters, line numbers, segment records, filenames and trie labels:
+       */
+      for ( std::vector< id_type >::const_iterator id = m_order.begin(); id != m_order.end(); ++id )
+      {
+         Dictionary::word_type const word = m_words.word( *id );
+         out.write( word.begin(), word.end() );
+      }
+
+      for ( std::vector< id_type >::const_iterator id = m_order.begin(); id != m_order.end(); ++id )
+      {
+         char const* const bytes = reinterpret_cast< char const* >( m_lines[ *id ].encoded_data() );
+         out.write( bytes, bytes + m_lines[ *id ].encoded_size() );
+      }
+
+      if ( !records.empty() )
+      {
+         char const* const bytes = reinterpret_cast< char const* >( &records[ 0 ] );
+         out.write( bytes, bytes + records.size() );
+      }
+
+      for ( files_type::const_iterator pos = m_files.begin(); pos != m_files.end(); ++pos )
+      {
+         out.write( pos->name );
+      }
+
+      out.write( trie.chars(), trie.chars() + trie.chars_size() );
+   }
+
+private:
+   /**
+    * the word number type.
+    */
+   typedef Dictionary::id_type id_type;
+
+   /**
+    * the encoded segment records of a word: per file its number and its
+    * number of occurrences, see encode_number().
+    */
+   typedef std::vector< Postings::byte_type > records_type;
+
+   /**
+    * a decoded segment record: the occurrences of a word in one file.
+    */
+   struct Segment
+   {
+      size_type  file;    ///< the file number
+      count_type count;   ///< the number of occurrences
+      size_type  first;   ///< the position of its first line number in the word's line numbers
+   };
+
+   /**
+    * segment order on file number.
+    */
+   static bool file_less( Segment const& a, Segment const& b )
+   {
+      return a.file < b.file;
+   }
+
+   /**
+    * segment order on descending file number, to find segments out of order.
+    */
+   static bool file_greater( Segment const& a, Segment const& b )
+   {
+      return a.file > b.file;
+   }
+
+   /**
+    * word number order on word.
+    */
+   class IdLess
+   {
+   public:
+      IdLess( Dictionary const& words ) : m_words( &words ) { ; }
+
+      bool operator()( id_type const a, id_type const b ) const
+      {
+         return m_words->less( a, b );
+      }
+
+   private:
+      Dictionary const* m_words;
+   };
+
+   /**
+    * add a segment record for the given word; return the word's number.
+    */
+   template < typename W >
+   const id_type add_segment( W const& word, size_type const file, count_type const count )
+   {
+      bool added = false;
+      id_type const id = m_words.intern( word.begin(), word.end(), hash_bytes( word.begin(), word.end() ), added );
+
+      if ( added )
+      {
+         m_lines.push_back( Postings() );
+         m_records.push_back( records_type() );
+      }
+
+      encode_number( m_records[ id ], file );
+      encode_number( m_records[ id ], count );
+
+      return id;
+   }
+
+   /**
+    * decode the given segment records, in the order added.
+    */
+   static void decode( records_type const& records, std::vector< Segment >& segments )
+   {
+      segments.clear();
+
+      Postings::byte_type const* pos = records.empty() ? NULL : &records[ 0 ];
+      Postings::byte_type const* const end = pos + records.size();
+
+      size_type first = 0;
+      offset_type file = 0, count = 0;
+
+      while ( decode_number( pos, end, file ) && decode_number( pos, end, count ) )
+      {
+         Segment const segment = { static_cast< size_type >( file ), count, first };
+         segments.push_back( segment );
+
+         first += static_cast< size_type >( count );
+      }
+   }
+
+   /**
+    * order the words, and the segments of each word on file number.
+    */
+   void sort()
+   {
+      m_order.resize( m_words.size() );
+
+      std::vector< Segment > segments;
+      std::vector< Postings::value_type > lines;
+
+      for ( id_type id = 0; id < m_order.size(); ++id )
+      {
+         m_order[ id ] = id;
+
+         decode( m_records[ id ], segments );
+
+         // files are mostly added in order:
+         if ( std::adjacent_find( segments.begin(), segments.end(), file_greater ) == segments.end() )
+         {
+            continue;
+         }
+
+         std::stable_sort( segments.begin(), segments.end(), file_less );
+
+         records_type records;
+         Postings ordered;
+
+         lines.assign( m_lines[ id ].begin(), m_lines[ id ].end() );
+
+         for ( std::vector< Segment >::const_iterator pos = segments.begin(); pos != segments.end(); ++pos )
+         {
+            encode_number( records, pos->file );
+            encode_number( records, pos->count );
+
+            if ( !m_count_only )
+            {
+               for ( size_type i = pos->first; i < pos->first + pos->count && i < lines.size(); ++i )
+               {
+                  ordered.push_back( lines[ i ] );
+               }
+            }
+         }
+
+         m_records[ id ].swap( records );
+         m_lines[ id ].swap( ordered );
+      }
+
+      std::sort( m_order.begin(), m_order.end(), IdLess( m_words ) );
+   }
+
+   /**
+    * append a number.
+    */
+   static void put( OutputBuffer& out, offset_type const value )
+   {
+      char const* const bytes = reinterpret_cast< char const* >( &value );
+      out.write( bytes, bytes + sizeof value );
+   }
+
+   bool           m_count_only;  ///< true if only counting words
+   size_type      m_keywords;    ///< number of keywords in use
+   offset_type    m_signature;   ///< signature of the options in use
+   file_time_type m_started;     ///< the time the index was started, see set_started()
+   files_type     m_files;       ///< the files
+   Dictionary     m_words;       ///< the words
+   std::vector< Postings >      m_lines;    ///< the line numbers of each word, by word number, per file as added
+   std::vector< records_type >  m_records;  ///< the segment records of each word, by word number, per file as added
+   std::vector< id_type >       m_order;    ///< the word numbers in word order, see sort()
+};
+
+} // namespace wordindex
+
+#endif // indexfile_h_included
+
+/*
+ * end of file
+ */
@@ -0,0 +1,441 @@
+/*
+ * KeywordScanner.h - multi-pattern keyword scanner (Aho-Corasick).
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef keywordscanner_h_included
+#define keywordscanner_h_included
+
+#include "Hash.h"       // for hash_bytes(), hash_add()
+#include "KeywordSet.h" // for class KeywordSet
+#include "ScanKernel.h" // for class ByteSet, find_in_set(), count_newlines()
+#include "Tokenizer.h"  // for class CharClasses
+#include "TokenView.h"  // for class TokenView
+#include "Utility.h"    // for class UnCopyable
+
+#include <cctype>       // for tolower()
+#include <algorithm>    // for std::min()
+#include <deque>        // for std::deque<>
+#include <string>       // for std::string
+#include <vector>       // for std::vector<>
+
+namespace wordindex {
+
+/**
+ * find the tokens that are keywords in a character range without tokenizing
+ * it: a deterministic Aho-Corasick automaton over all keywords runs over the
+ * characters with one table lookup per character. Where a keyword ends at the
+ * end of a run of token characters, the run's token is determined as the
+ * range tokenizer would and looked up in the keyword set. The result equals
+ * that of tokenizing the range and keeping only the keywords.
+ *
+ * A character that neither starts a token nor occurs in a keyword ends any
+ * match. A run of skip_run such characters leads to a skip state from where
+ * the characters up to the next start character are passed with the
+ * tokenizer's vectorized search; shorter runs, like the separators in text,
+ * are cheaper to pass through the automaton.
+ */
+class KeywordScanner : private UnCopyable
+{
+public:
+   /**
+    * the largest number of keywords to build a scanner for; the automaton
+    * grows with the total length of the keywords.
+    */
+   enum { max_keywords = 4096 };
+
+   /**
+    * the length of a run of skip characters after which to skip ahead.
+    */
+   enum { skip_run = 4 };
+
+   /**
+    * the line number type.
+    */
+   typedef int line_number_type;
+
+   /**
+    * constructor; when lowercase is set, tokens are transformed to lowercase
+    * before they are looked up, see basic_range_tokenizer::set_lowercase().
+    */
+   KeywordScanner( KeywordSet const& keywords, bool const lowercase )
+   : m_keywords ( &keywords )
+   , m_lowercase( lowercase )
+   , m_classes  ()
+   , m_start_set( m_classes.byte_set( CharClasses::start ) )
+   {
+      std::vector< std::string > words;
+      keywords.copy_to( words );
+
+      build( words );
+   }
+
+   /**
+    * add the keywords in [first, last) with their line numbers to the given index.
+    */
+   template < typename I >
+   void scan( char const* first, char const* last, I& index ) const
+   {
+      state_type const* const delta = &m_delta[ 0 ];
+
+      char const* counted = first;          // newlines counted up to here
+      line_number_type line = 1;
+
+      std::string lower;
+      long skipped = 0;                     // not used: lines are counted per keyword
+
+      state_type state = 0;
+
+      for ( char const* pos = first; pos != last; ++pos )
+      {
+         state = delta[ state + m_class[ static_cast< unsigned char >( *pos ) ] ];
+
+         if ( state < m_first_output )
+         {
+            continue;
+         }
+
+         /*
+          * no match in progress: skip to just before where a token can start:
+          */
+         if ( state == m_skip )
+         {
+            if ( pos + 1 != last && !m_classes.is( pos[ 1 ], CharClasses::start ) )
+            {
+               pos = find_in_set( pos + 1, last, m_start_set, skipped ) - 1;
+            }
+            continue;
+         }
+
+         /*
+          * a keyword ends here; only a token ending here can be a keyword:
+          */
+         char const* const end = pos + 1;
+
+         if ( end != last && m_classes.is( *end, CharClasses::token ) )
+         {
+            continue;
+         }
+
+         char const* const begin = token_begin( first, end );
+
+         if ( begin == end )
+         {
+            continue;
+         }
+
+         TokenView word( begin, end );
+         hash_type hash = hash_basis;
+
+         if ( m_lowercase )
+         {
+            lower.resize( end - begin );
+
+            for ( std::size_t i = 0; i < lower.size(); ++i )
+            {
+               lower[ i ] = static_cast< char >( tolower( begin[ i ] ) );
+               hash = hash_add( hash, lower[ i ] );
+            }
+            word = TokenView( lower.data(), lower.data() + lower.size() );
+         }
+         else
+         {
+            hash = hash_bytes( begin, end );
+         }
+
+         if ( m_keywords->contains( word, hash ) )
+         {
+            line   += count_newlines( counted, begin );
+            counted = begin;
+
+            index.insert( word, hash, line );
+         }
+      }
+   }
+
+   /**
+    * number of automaton states.
+    */
+   const std::size_t states() const
+   {
+      return m_delta.size() / m_class_count;
+   }
+
+private:
+   /**
+    * the state type: state number times the number of character classes.
+    */
+   typedef unsigned int state_type;
+
+   /**
+    * the begin of the token that ends at end, as the range tokenizer finds it:
+    * the first start character in the run of token characters before end;
+    * end if there is none.
+    */
+   char const* token_begin( char const* first, char const* end ) const
+   {
+      char const* run = end;
+
+      while ( run != first && m_classes.is( run[ -1 ], CharClasses::token ) )
+      {
+         --run;
+      }
+
+      while ( run != end && !m_classes.is( *run, CharClasses::start ) )
+      {
+         ++run;
+      }
+      return run;
+   }
+
+   /**
+    * build the automaton for the given keywords.
+    */
+   void build( std::vector< std::string > const& words )
+   {
+      /*
+       * character classes: one per character that occurs in a keyword, 0 for
+       * other start characters and 1 for the other characters (skip class);
+       * when transforming to lowercase, a character has the class of its lowercase:
+       */
+      enum { other_class = 0, skip_class = 1 };
+
+      std::vector< unsigned int > class_of( table_size, other_class );
+      m_class_count = 2;
+
+      for ( std::vector< std::string >::const_iterator word = words.begin(); word != words.end(); ++word )
+      {
+         for ( std::string::const_iterator chr = word->begin(); chr != word->end(); ++chr )
+         {
+            unsigned int& cls = class_of[ static_cast< unsigned char >( *chr ) ];
+
+            if ( other_class == cls )
+            {
+               cls = m_class_count++;
+            }
+         }
+      }
+
+      for ( int chr = 0; chr < table_size; ++chr )
+      {
+         m_class[ chr ] = class_of[ m_lowercase ? static_cast< unsigned char >( tolower( chr ) ) : chr ];
+
+         if ( other_class == m_class[ chr ] && !m_classes.is( static_cast< char >( chr ), CharClasses::start ) )
+         {
+            m_class[ chr ] = skip_class;
+         }
+      }
+
+      /*
+       * trie of the keywords; state 0 is the root:
+       */
+      std::vector< std::vector< int > > next( 1, std::vector< int >( m_class_count, -1 ) );
+      std::vector< bool > output( 1, false );
+
+      for ( std::vector< std::string >::const_iterator word = words.begin(); word != words.end(); ++word )
+      {
+         int state = 0;
+
+         for ( std::string::const_iterator chr = word->begin(); chr != word->end(); ++chr )
+         {
+            unsigned int const cls = class_of[ static_cast< unsigned char >( *chr ) ];
+
+            if ( next[ state ][ cls ] < 0 )
+            {
+               next[ state ][ cls ] = static_cast< int >( next.size() );
+               next.push_back( std::vector< int >( m_class_count, -1 ) );
+               output.push_back( false );
+            }
+            state = next[ state ][ cls ];
+         }
+         output[ state ] = !word->empty();
+      }
+
+      /*
+       * complete the transitions breadth-first along the failure links, so that
+       * each state has a transition for every class; a state has output if
+       * a keyword ends in it or in its failure state:
+       */
+      std::vector< int > fail( next.size(), 0 );
+      std::deque< int > queue;
+
+      for ( unsigned int cls = 0; cls < m_class_count; ++cls )
+      {
+         int& to = next[ 0 ][ cls ];
+
+         if ( to < 0 )
+         {
+            to = 0;
+         }
+         else
+         {
+            queue.push_back( to );
+         }
+      }
+
+      std::vector< int > order( 1, 0 );
+
+      while ( !queue.empty() )
+      {
+         int const state = queue.front(); queue.pop_front();
+
+         order.push_back( state );
+         output[ state ] = output[ state ] || output[ fail[ state ] ];
+
+         for ( unsigned int cls = 0; cls < m_class_count; ++cls )
+         {
+            int& to = next[ state ][ cls ];
+
+            if ( to < 0 )
+            {
+               to = next[ fail[ state ] ][ cls ];
+            }
+            else
+            {
+               fail[ to ] = next[ fail[ state ] ][ cls ];
+               queue.push_back( to );
+            }
+         }
+      }
+
+      /*
+       * the skip class leads from every state along a chain of skip_run
+       * states that behave as the root otherwise; the last is the skip state:
+       */
+      std::vector< int > const root = next[ 0 ];
+      int const chain = static_cast< int >( next.size() );
+
+      for ( std::size_t state = 0; state < next.size(); ++state )
+      {
+         next[ state ][ skip_class ] = chain;
+      }
+
+      for ( int i = 0; i < skip_run; ++i )
+      {
+         next.push_back( root );
+         next.back()[ skip_class ] = chain + std::min( i + 1, skip_run - 1 );
+         output.push_back( false );
+         order.push_back( chain + i );
+      }
+
+      int const skip = order.back(); order.pop_back();
+
+      /*
+       * number the states so that those with output come after the others,
+       * followed by the skip state, and store the transitions as premultiplied
+       * state numbers:
+       */
+      std::vector< state_type > number( next.size() );
+      state_type count = 0;
+
+      for ( int pass = 0; pass < 2; ++pass )
+      {
+         if ( 1 == pass )
+         {
+            m_first_output = count * m_class_count;
+         }
+
+         for ( std::size_t i = 0; i < order.size(); ++i )
+         {
+            if ( output[ order[ i ] ] == ( 1 == pass ) )
+            {
+               number[ order[ i ] ] = count++;
+            }
+         }
+      }
+
+      number[ skip ] = count;
+      m_skip = count * m_class_count;
+
+      m_delta.assign( next.size() * m_class_count, 0 );
+
+      for ( std::size_t state = 0; state < next.size(); ++state )
+      {
+         for ( unsigned int cls = 0; cls < m_class_count; ++cls )
+         {
+            m_delta[ number[ state ] * m_class_count + cls ] = number[ next[ state ][ cls ] ] * m_class_count;
+         }
+      }
+   }
+
+   /**
+    * the number of character table entries.
+    */
+   enum { table_size = 256 };
+
+   /**
+    * the keywords.
+    */
+   KeywordSet const* m_keywords;
+
+   /**
+    * transform tokens to lowercase.
+    */
+   bool m_lowercase;
+
+   /**
+    * the token character classes.
+    */
+   CharClasses m_classes;
+
+   /**
+    * the token start characters.
+    */
+   ByteSet m_start_set;
+
+   /**
+    * the automaton's character class of each character.
+    */
+   unsigned int m_class[ table_size ];
+
+   /**
+    * number of automaton character classes.
+    */
+   unsigned int m_class_count;
+
+   /**
+    * the transitions: for each state and class the premultiplied next state.
+    */
+   std::vector< state_type > m_delta;
+
+   /**
+    * the first premultiplied state in which a keyword ends.
+    */
+   state_type m_first_output;
+
+   /**
+    * the premultiplied skip state.
+    */
+   state_type m_skip;
+};
+
+} // namespace wordindex
+
+#endif // keywordscanner_h_included
+
+/*
+ * end of file
+ */
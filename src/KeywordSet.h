@@ -0,0 +1,196 @@
+/*
+ * KeywordSet.h - hashed set of keywords (stopwords).
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef keywordset_h_included
+#define keywordset_h_included
+
+#include "Dictionary.h" // for class Dictionary
+#include "Hash.h"       // for hash_type, hash_string()
+#include "StopwordTable.h" // for class StopwordTable
+#include "TokenView.h"  // for class TokenView
+#include "Utility.h"    // for class UnCopyable
+
+#include <cstddef>      // for std::size_t
+#include <string>       // for std::string
+#include <vector>       // for std::vector<>
+
+namespace wordindex {
+
+/**
+ * set of keywords in a flat, open-addressing hash table; tokens are looked up
+ * by view and the hash the tokenizer computed, without copying them. The set
+ * may also include the words of perfect-hash tables, compiled-in or mapped.
+ */
+class KeywordSet : private UnCopyable
+{
+public:
+   /**
+    * the value type.
+    */
+   typedef std::string value_type;
+
+   /**
+    * the size type.
+    */
+   typedef std::size_t size_type;
+
+   /**
+    * constructor.
+    */
+   KeywordSet()
+   : m_shared( 0 )
+   {
+      ;
+   }
+
+   /**
+    * also include the words of the given table, whose arrays must outlive
+    * this set; use before inserting words.
+    */
+   void use( StopwordTable const& table )
+   {
+      // count words in several tables once; scan the smaller table:
+      for ( std::vector< StopwordTable >::const_iterator pos = m_tables.begin(); pos != m_tables.end(); ++pos )
+      {
+         m_shared += table.size() < pos->size() ? table.shared( *pos ) : pos->shared( table );
+      }
+
+      m_tables.push_back( table );
+   }
+
+   /**
+    * number of keywords.
+    */
+   const size_type size() const
+   {
+      size_type size = m_words.size();
+
+      for ( std::vector< StopwordTable >::const_iterator pos = m_tables.begin(); pos != m_tables.end(); ++pos )
+      {
+         size += pos->size();
+      }
+      return size - m_shared;
+   }
+
+   /**
+    * true if there are no keywords.
+    */
+   const bool empty() const
+   {
+      return 0 == size();
+   }
+
+   /**
+    * add a keyword.
+    */
+   void insert( value_type const& word )
+   {
+      if ( 0 == count( word ) )
+      {
+         m_words.intern( word );
+      }
+   }
+
+   /**
+    * 1 if the given word is a keyword, 0 otherwise.
+    */
+   const size_type count( value_type const& word ) const
+   {
+      return contains( TokenView( word.data(), word.data() + word.size() ), hash_string( word ) ) ? 1 : 0;
+   }
+
+   /**
+    * true if the given token with the given hash is a keyword.
+    */
+   const bool contains( TokenView const& word, hash_type const hash ) const
+   {
+      for ( std::vector< StopwordTable >::const_iterator pos = m_tables.begin(); pos != m_tables.end(); ++pos )
+      {
+         if ( pos->contains( word, hash ) )
+         {
+            return true;
+         }
+      }
+
+      return !m_words.empty() && Dictionary::npos != m_words.find( word.begin(), word.end(), hash );
+   }
+
+   /**
+    * start loading what looking up a token with the given hash needs.
+    */
+   void prefetch( hash_type const hash ) const
+   {
+      m_words.prefetch( hash );
+   }
+
+   /**
+    * append all keywords to the given list; words in several tables appear more than once.
+    */
+   void copy_to( std::vector< std::string >& words ) const
+   {
+      for ( Dictionary::id_type id = 0; id < m_words.size(); ++id )
+      {
+         words.push_back( m_words.word( id ).str() );
+      }
+
+      for ( std::vector< StopwordTable >::const_iterator pos = m_tables.begin(); pos != m_tables.end(); ++pos )
+      {
+         for ( StopwordTable::offset_type slot = 0; slot < pos->slots(); ++slot )
+         {
+            if ( pos->offsets()[ slot ] != pos->offsets()[ slot + 1 ] )
+            {
+               words.push_back( std::string( pos->chars() + pos->offsets()[ slot ], pos->chars() + pos->offsets()[ slot + 1 ] ) );
+            }
+         }
+      }
+   }
+
+private:
+   /**
+    * the tables of words also included.
+    */
+   std::vector< StopwordTable > m_tables;
+
+   /**
+    * number of words that occur in more than one table.
+    */
+   size_type m_shared;
+
+   /**
+    * the keywords.
+    */
+   Dictionary m_words;
+};
+
+} // namespace wordindex
+
+#endif // keywordset_h_included
+
+/*
+ * end of file
+ */
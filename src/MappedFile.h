@@ -0,0 +1,362 @@
+/*
+ * MappedFile.h - read-only memory-mapped file.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef mappedfile_h_included
+#define mappedfile_h_included
+
+#include "Utility.h"  // for class UnCopyable, to_charptr()
+
+#include <string>     // for std::string
+
+#ifdef _WIN32
+# include <windows.h>           // for CreateFileMapping() etc.
+#else
+# include <fcntl.h>             // for open()
+# include <sys/mman.h>          // for mmap()
+# include <sys/stat.h>          // for fstat(), stat()
+# include <unistd.h>            // for close()
+#endif
+
+namespace wordindex {
+
+/**
+ * true if the specified file is a regular disk file (not a pipe, device or directory).
+ */
+inline const bool is_regular_file( std::string const& filename )
+{
+#ifdef _WIN32
+   DWORD const attr = GetFileAttributesA( to_charptr( filename ) );
+   return INVALID_FILE_ATTRIBUTES != attr && 0 == ( attr & ( FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_DEVICE ) );
+#else
+   struct stat st;
+   return 0 == stat( to_charptr( filename ), &st ) && S_ISREG( st.st_mode );
+#endif
+}
+
+/**
+ * the file size type.
+ */
+typedef unsigned long long file_size_type;
+
+/**
+ * the size of the specified file in bytes; 0 if it does not exist or is not a regular file.
+ */
+inline const file_size_type file_size( std::string const& filename )
+{
+#ifdef _WIN32
+   WIN32_FILE_ATTRIBUTE_DATA data;
+
+   if ( !GetFileAttributesExA( to_charptr( filename ), GetFileExInfoStandard, &data ) || ( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) )
+   {
+      return 0;
+   }
+   return ( static_cast< file_size_type >( data.nFileSizeHigh ) << 32 ) | data.nFileSizeLow;
+#else
+   struct stat st;
+   return 0 == stat( to_charptr( filename ), &st ) && S_ISREG( st.st_mode ) ? st.st_size : 0;
+#endif
+}
+
+/**
+ * the file modification time type.
+ */
+typedef long long file_time_type;
+
+/**
+ * the last modification time of the specified file, in nanoseconds since the
+ * epoch (POSIX) or in 100 ns ticks (Windows); 0 if it does not exist.
+ */
+inline const file_time_type file_time( std::string const& filename )
+{
+#ifdef _WIN32
+   WIN32_FILE_ATTRIBUTE_DATA data;
+
+   if ( !GetFileAttributesExA( to_charptr( filename ), GetFileExInfoStandard, &data ) )
+   {
+      return 0;
+   }
+   return ( static_cast< file_time_type >( data.ftLastWriteTime.dwHighDateTime ) << 32 ) | data.ftLastWriteTime.dwLowDateTime;
+#else
+   struct stat st;
+
+   if ( 0 != stat( to_charptr( filename ), &st ) )
+   {
+      return 0;
+   }
+#ifdef __APPLE__
+   return static_cast< file_time_type >( st.st_mtimespec.tv_sec ) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+   return static_cast< file_time_type >( st.st_mtim.tv_sec ) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+#endif
+}
+
+/**
+ * number of bytes at the start of a file to ask the system to load ahead, see read_ahead().
+ */
+file_size_type const read_ahead_size = 16 << 20;
+
+/**
+ * hint that the given open file will be read sequentially.
+ */
+inline void advise_sequential( int const fd )
+{
+#if !defined( _WIN32 ) && defined( POSIX_FADV_SEQUENTIAL )
+   posix_fadvise( fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+}
+
+/**
+ * ask the system to start loading the beginning of the specified regular
+ * file in the background, for it is read next; pipes and devices are left alone.
+ */
+inline void read_ahead( std::string const& filename )
+{
+#if !defined( _WIN32 ) && defined( POSIX_FADV_WILLNEED )
+   if ( !is_regular_file( filename ) )
+   {
+      return;
+   }
+
+   int const fd = ::open( to_charptr( filename ), O_RDONLY );
+
+   if ( fd >= 0 )
+   {
+      advise_sequential( fd );
+      posix_fadvise( fd, 0, static_cast< off_t >( read_ahead_size ), POSIX_FADV_WILLNEED );
+      ::close( fd );
+   }
+#endif
+}
+
+/**
+ * a file mapped read-only into memory, presented as a contiguous character range.
+ */
+class MappedFile : private UnCopyable
+{
+public:
+   /**
+    * the character type.
+    */
+   typedef char char_type;
+
+   /**
+    * the size type.
+    */
+   typedef std::size_t size_type;
+
+   /**
+    * the const iterator type.
+    */
+   typedef char_type const* const_iterator;
+
+   /**
+    * constructor; map the given file, see is_open().
+    */
+   explicit MappedFile( std::string const& filename )
+   : m_data( NULL )
+   , m_size( 0    )
+   , m_open( false )
+#ifdef _WIN32
+   , m_mapping( NULL )
+#endif
+   {
+      open( filename );
+   }
+
+   /**
+    * destructor; unmap the file.
+    */
+   ~MappedFile()
+   {
+      close();
+   }
+
+   /**
+    * true if the file has been mapped successfully.
+    */
+   const bool is_open() const
+   {
+      return m_open;
+   }
+
+   /**
+    * begin of file contents.
+    */
+   const_iterator begin() const
+   {
+      return m_data;
+   }
+
+   /**
+    * end of file contents.
+    */
+   const_iterator end() const
+   {
+      return m_data + m_size;
+   }
+
+   /**
+    * size of file contents in bytes.
+    */
+   const size_type size() const
+   {
+      return m_size;
+   }
+
+private:
+#ifdef _WIN32
+   /**
+    * map the given file.
+    */
+   void open( std::string const& filename )
+   {
+      HANDLE file = CreateFileA( to_charptr( filename ), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+
+      if ( INVALID_HANDLE_VALUE == file )
+      {
+         return;
+      }
+
+      LARGE_INTEGER size;
+
+      if ( GetFileSizeEx( file, &size ) )
+      {
+         m_size = static_cast< size_type >( size.QuadPart );
+         m_open = true;
+
+         // an empty file cannot be mapped; leave the range empty:
+         if ( m_size > 0 )
+         {
+            m_mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+            m_data    = m_mapping ? static_cast< char_type const* >( MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 ) ) : NULL;
+            m_open    = NULL != m_data;
+         }
+      }
+
+      CloseHandle( file );
+   }
+
+   /**
+    * unmap the file.
+    */
+   void close()
+   {
+      if ( m_data )
+      {
+         UnmapViewOfFile( m_data );
+      }
+
+      if ( m_mapping )
+      {
+         CloseHandle( m_mapping );
+      }
+   }
+#else
+   /**
+    * map the given file.
+    */
+   void open( std::string const& filename )
+   {
+      int const fd = ::open( to_charptr( filename ), O_RDONLY );
+
+      if ( fd < 0 )
+      {
+         return;
+      }
+
+      advise_sequential( fd );
+
+      struct stat st;
+
+      if ( 0 == fstat( fd, &st ) )
+      {
+         m_size = static_cast< size_type >( st.st_size );
+         m_open = true;
+
+         // an empty file cannot be mapped; leave the range empty:
+         if ( m_size > 0 )
+         {
+            void* const data = mmap( NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+            m_open = MAP_FAILED != data;
+            m_data = m_open ? static_cast< char_type const* >( data ) : NULL;
+#ifdef MADV_SEQUENTIAL
+            if ( m_open )
+            {
+               madvise( data, m_size, MADV_SEQUENTIAL );
+            }
+#endif
+         }
+      }
+
+      ::close( fd );
+   }
+
+   /**
+    * unmap the file.
+    */
+   void close()
+   {
+      if ( m_data )
+      {
+         munmap( const_cast< char_type* >( m_data ), m_size );
+      }
+   }
+#endif
+
+   /**
+    * the mapped file contents; NULL if empty or not mapped.
+    */
+   char_type const* m_data;
+
+   /**
+    * the file size in bytes.
+    */
+   size_type m_size;
+
+   /**
+    * true if the file has been mapped.
+    */
+   bool m_open;
+
+#ifdef _WIN32
+   /**
+    * the file mapping handle.
+    */
+   HANDLE m_mapping;
+#endif
+};
+
+} // namespace wordindex
+
+#endif // mappedfile_h_included
+
+/*
+ * end of file
+ */
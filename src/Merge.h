@@ -0,0 +1,551 @@
+/*
+ * Merge.h - partial word indexes and their parallel k-way merge.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef merge_h_included
+#define merge_h_included
+
+#include "Dictionary.h" // for class wordindex::Dictionary
+#include "Hash.h"       // for hash_type, hash_string()
+#include "Pair.h"       // for class wordindex::Pair<>
+#include "Parallel.h"   // for run_parallel()
+#include "Postings.h"   // for class Postings
+#include "TokenView.h"  // for class TokenView
+#include "Utility.h"    // for class wordindex::UnCopyable
+#include "WordIndex.h"  // for class wordindex::WordIndex
+
+#include <algorithm>    // for std::sort(), std::lower_bound(), std::push_heap() etc.
+#include <deque>        // for std::deque<>
+#include <string>       // for std::string
+#include <vector>       // for std::vector<>
+
+namespace wordindex {
+
+/**
+ * a worker's part of the word index: the words of the files it read, with
+ * their line numbers per file. Words are interned in a dictionary and their
+ * line numbers are compressed, as in class WordIndex; as files are read in
+ * any order, each word also notes where the line numbers of a next file
+ * start, so they can be put in file order when the partial indexes are merged.
+ */
+class PartialIndex : private UnCopyable
+{
+public:
+   /**
+    * the word type: a view into the dictionary.
+    */
+   typedef Dictionary::word_type word_type;
+
+   /**
+    * the word number type.
+    */
+   typedef Dictionary::id_type id_type;
+
+   /**
+    * the line number type.
+    */
+   typedef Postings::value_type line_number_type;
+
+   /**
+    * the file number type (position in the filename list).
+    */
+   typedef Postings::value_type file_number_type;
+
+   /**
+    * the occurrence count type.
+    */
+   typedef WordIndex::count_type count_type;
+
+   /**
+    * the token--line number pair type.
+    */
+   typedef Pair< std::string, line_number_type > token_type;
+
+   /**
+    * constructor.
+    */
+   PartialIndex()
+   : m_file( 0 )
+   , m_lines( 0 )
+   {
+      ;
+   }
+
+   /**
+    * set the file subsequent tokens are read from.
+    */
+   void set_file( file_number_type const file )
+   {
+      m_file = file;
+   }
+
+   /**
+    * add a token, line number pair.
+    */
+   void insert( token_type const& pair )
+   {
+      insert( pair.first, pair.second );
+   }
+
+   /**
+    * add a token and line number.
+    */
+   void insert( std::string const& s, line_number_type const n )
+   {
+      insert( word_type( s.data(), s.data() + s.size() ), hash_string( s ), n );
+   }
+
+   /**
+    * add a token with its hash, see hash_bytes(), and line number.
+    */
+   void insert( word_type const& word, hash_type const hash, line_number_type const n )
+   {
+      id_type const id = intern( word.begin(), word.end(), hash );
+
+      m_postings[ id ].push_back( n );
+      ++m_lines;
+   }
+
+   /**
+    * start loading what adding a token with the given hash needs.
+    */
+   void prefetch( hash_type const hash ) const
+   {
+      m_words.prefetch( hash );
+   }
+
+   /**
+    * add the tokens of another index read from the current file, with the
+    * given offset added to their line numbers.
+    */
+   void append( PartialIndex const& other, line_number_type const offset = 0 )
+   {
+      for ( id_type id = 0; id < other.m_words.size(); ++id )
+      {
+         word_type const word = other.m_words.word( id );
+         id_type const to = intern( word.begin(), word.end(), other.m_words.hash( id ) );
+
+         m_postings[ to ].append( other.m_postings[ id ], offset );
+      }
+      m_lines += other.m_lines;
+   }
+
+   /**
+    * order the words; files may have been read in any order, see files().
+    */
+   void sort()
+   {
+      m_order.resize( m_words.size() );
+
+      for ( id_type id = 0; id < m_order.size(); ++id )
+      {
+         m_order[ id ] = id;
+      }
+
+      std::sort( m_order.begin(), m_order.end(), IdLess( m_words ) );
+   }
+
+   /**
+    * number of distinct words.
+    */
+   const int words() const
+   {
+       return m_words.size();
+   }
+
+   /**
+    * number of line references.
+    */
+   const count_type lines() const
+   {
+      return m_lines;
+   }
+
+   /**
+    * the number of the word at the given position in word order, see sort().
+    */
+   const id_type at( std::size_t const n ) const
+   {
+      return m_order[ n ];
+   }
+
+   /**
+    * the position in word order of the first word not less than the given word.
+    */
+   const std::size_t lower_bound( std::string const& word ) const
+   {
+      return std::lower_bound( m_order.begin(), m_order.end(), word_type( word.data(), word.data() + word.size() ), IdWordLess( m_words ) ) - m_order.begin();
+   }
+
+   /**
+    * the word with the given number.
+    */
+   const word_type word( id_type const id ) const
+   {
+      return m_words.word( id );
+   }
+
+   /**
+    * the hash of the word with the given number.
+    */
+   const hash_type hash( id_type const id ) const
+   {
+      return m_words.hash( id );
+   }
+
+   /**
+    * the line numbers of the word with the given number, per file in the order read.
+    */
+   Postings const& postings( id_type const id ) const
+   {
+      return m_postings[ id ];
+   }
+
+   /**
+    * the files the word with the given number was read from, in the order read.
+    */
+   Postings const& files( id_type const id ) const
+   {
+      return m_files[ id ];
+   }
+
+   /**
+    * the position in postings() of the first line number of each file in files().
+    */
+   Postings const& starts( id_type const id ) const
+   {
+      return m_starts[ id ];
+   }
+
+private:
+   /**
+    * the number of the word [first, last) with the given hash, added if not
+    * present; the word's line numbers of the current file start here if new.
+    */
+   const id_type intern( char const* first, char const* last, hash_type const hash )
+   {
+      bool added = false;
+      id_type const id = m_words.intern( first, last, hash, added );
+
+      if ( added )
+      {
+         m_postings.push_back( Postings() );
+         m_files.push_back( Postings() );
+         m_starts.push_back( Postings() );
+      }
+
+      if ( added || m_files[ id ].back() != m_file )
+      {
+         m_files[ id ].push_back( m_file );
+         m_starts[ id ].push_back( m_postings[ id ].size() );
+      }
+      return id;
+   }
+
+   /**
+    * word number order on word.
+    */
+   class IdLess
+   {
+   public:
+      IdLess( Dictionary const& words ) : m_words( &words ) { ; }
+
+      bool operator()( id_type const a, id_type const b ) const
+      {
+         return m_words->less( a, b );
+      }
+
+   private:
+      Dictionary const* m_words;
+   };
+
+   /**
+    * word number order against a word, for lower_bound().
+    */
+   class IdWordLess
+   {
+   public:
+      IdWordLess( Dictionary const& words ) : m_words( &words ) { ; }
+
+      bool operator()( id_type const a, word_type const& b ) const
+      {
+         return m_words->word( a ) < b;
+      }
+
+   private:
+      Dictionary const* m_words;
+   };
+
+   file_number_type         m_file;      ///< the current file number
+   count_type               m_lines;     ///< number of line references
+   Dictionary               m_words;     ///< the words
+   std::vector< Postings >  m_postings;  ///< the compressed line numbers of each word, by word number
+   std::vector< Postings >  m_files;     ///< the files of each word, by word number
+   std::vector< Postings >  m_starts;    ///< the start of each file's line numbers of each word, by word number
+   std::vector< id_type >   m_order;     ///< the word numbers in word order, see sort()
+};
+
+/**
+ * merge the words in key range [first, last) of the partial indexes into a
+ * word index; an empty last means up to the end. A word's line numbers from
+ * the partial indexes are merged in file order.
+ */
+class PartitionMerger
+{
+public:
+   /**
+    * the partial index list type.
+    */
+   typedef std::vector< PartialIndex const* > parts_type;
+
+   /**
+    * constructor.
+    */
+   PartitionMerger( parts_type const& parts, std::string const& first, std::string const& last, WordIndex& result )
+   : m_parts ( &parts )
+   , m_first ( first )
+   , m_last  ( last )
+   , m_result( &result )
+   {
+   }
+
+   /**
+    * merge the partition (thread function).
+    */
+   void operator()()
+   {
+      parts_type const& parts = *m_parts;
+
+      /*
+       * the range of each partial index within the partition, in word order:
+       */
+      std::vector< std::size_t > pos;
+      std::vector< std::size_t > end;
+
+      for ( parts_type::const_iterator part = parts.begin(); part != parts.end(); ++part )
+      {
+         pos.push_back( (*part)->lower_bound( m_first ) );
+         end.push_back( m_last.empty() ? (*part)->words() : (*part)->lower_bound( m_last ) );
+      }
+
+      /*
+       * k-way merge of the words through a heap of cursor numbers:
+       */
+      CursorGreater const greater( parts, pos );
+      std::vector< int > heap;
+
+      for ( std::size_t i = 0; i < pos.size(); ++i )
+      {
+         if ( pos[ i ] != end[ i ] ) heap.push_back( static_cast< int >( i ) );
+      }
+      std::make_heap( heap.begin(), heap.end(), greater );
+
+      std::vector< int > cursors;
+      std::vector< Run > runs;
+      std::vector< PartialIndex::line_number_type > lines;
+      std::vector< PartialIndex::line_number_type > ordered;
+
+      while ( !heap.empty() )
+      {
+         PartialIndex const& top = *parts[ heap.front() ];
+         PartialIndex::id_type const top_id = top.at( pos[ heap.front() ] );
+         PartialIndex::word_type const word = top.word( top_id );
+         hash_type const hash = top.hash( top_id );
+
+         /*
+          * collect the word's line numbers per file from all partial indexes:
+          */
+         cursors.clear();
+         runs.clear();
+         lines.clear();
+
+         while ( !heap.empty() && parts[ heap.front() ]->word( parts[ heap.front() ]->at( pos[ heap.front() ] ) ) == word )
+         {
+            std::pop_heap( heap.begin(), heap.end(), greater );
+            cursors.push_back( heap.back() );
+            heap.pop_back();
+         }
+
+         for ( std::vector< int >::const_iterator i = cursors.begin(); i != cursors.end(); ++i )
+         {
+            PartialIndex const& part = *parts[ *i ];
+            PartialIndex::id_type const id = part.at( pos[ *i ] );
+
+            std::size_t const base = lines.size();
+            lines.insert( lines.end(), part.postings( id ).begin(), part.postings( id ).end() );
+
+            Postings::const_iterator file = part.files( id ).begin();
+            Postings::const_iterator start = part.starts( id ).begin();
+
+            for ( ; file != part.files( id ).end(); ++file )
+            {
+               Run run = { *file, base + *start, 0 };
+               run.last = ++start != part.starts( id ).end() ? base + *start : lines.size();
+               runs.push_back( run );
+            }
+         }
+
+         // a file is read by one worker, so files are distinct:
+         std::sort( runs.begin(), runs.end(), file_less );
+
+         ordered.clear();
+
+         for ( std::vector< Run >::const_iterator run = runs.begin(); run != runs.end(); ++run )
+         {
+            ordered.insert( ordered.end(), lines.begin() + run->first, lines.begin() + run->last );
+         }
+
+         m_result->insert( word, hash, ordered.begin(), ordered.end() );
+
+         /*
+          * advance the cursors of this word:
+          */
+         for ( std::vector< int >::const_iterator i = cursors.begin(); i != cursors.end(); ++i )
+         {
+            if ( ++pos[ *i ] != end[ *i ] )
+            {
+               heap.push_back( *i );
+               std::push_heap( heap.begin(), heap.end(), greater );
+            }
+         }
+      }
+   }
+
+private:
+   /**
+    * the line numbers of a word read from one file.
+    */
+   struct Run
+   {
+      PartialIndex::file_number_type file;   ///< the file number
+      std::size_t                    first;  ///< position of the first line number
+      std::size_t                    last;   ///< position past the last line number
+   };
+
+   /**
+    * run order on file number.
+    */
+   static bool file_less( Run const& a, Run const& b )
+   {
+      return a.file < b.file;
+   }
+
+   /**
+    * heap order on cursor numbers: smallest word on top.
+    */
+   class CursorGreater
+   {
+   public:
+      CursorGreater( parts_type const& parts, std::vector< std::size_t > const& pos ) : m_parts( &parts ), m_pos( &pos ) { ; }
+
+      bool operator()( int const a, int const b ) const
+      {
+         return word( b ) < word( a );
+      }
+
+   private:
+      PartialIndex::word_type const word( int const cursor ) const
+      {
+         PartialIndex const& part = *(*m_parts)[ cursor ];
+         return part.word( part.at( (*m_pos)[ cursor ] ) );
+      }
+
+      parts_type const*                 m_parts;
+      std::vector< std::size_t > const* m_pos;
+   };
+
+   parts_type const* m_parts;  ///< the partial indexes
+   std::string       m_first;  ///< first word of partition
+   std::string       m_last;   ///< first word past partition; empty for end
+   WordIndex*        m_result; ///< the partition's merged words
+};
+
+/**
+ * merge the given partial indexes into result, splitting the words into
+ * key ranges that are merged concurrently, one per thread.
+ */
+inline void merge_parallel( std::vector< PartialIndex const* > const& parts, WordIndex& result, int const threads )
+{
+   /*
+    * choose partition boundaries from a sample of the words of each part:
+    */
+   std::vector< std::string > sample;
+
+   for ( std::vector< PartialIndex const* >::const_iterator part = parts.begin(); part != parts.end(); ++part )
+   {
+      int const step = std::max( 1, (*part)->words() / ( 8 * threads ) );
+
+      for ( int i = 0; i < (*part)->words(); i += step )
+      {
+         sample.push_back( (*part)->word( (*part)->at( i ) ).str() );
+      }
+   }
+
+   std::sort( sample.begin(), sample.end() );
+
+   std::vector< std::string > bounds( 1 );  // first partition starts at ""
+
+   for ( int i = 1; i < threads; ++i )
+   {
+      std::string const& bound = sample.empty() ? bounds.back() : sample[ sample.size() * i / threads ];
+
+      if ( bounds.back() < bound )
+      {
+         bounds.push_back( bound );
+      }
+   }
+   bounds.push_back( "" );  // last partition extends to the end
+
+   /*
+    * merge the partitions concurrently, each into its own word index:
+    */
+   std::deque< WordIndex > partitions( bounds.size() - 1 );
+   std::vector< PartitionMerger > mergers;
+
+   for ( std::size_t i = 0; i + 1 < bounds.size(); ++i )
+   {
+      mergers.push_back( PartitionMerger( parts, bounds[ i ], bounds[ i + 1 ], partitions[ i ] ) );
+   }
+
+   run_parallel( mergers );
+
+   /*
+    * concatenate the partitions, which hold ascending key ranges:
+    */
+   for ( std::size_t i = 0; i < partitions.size(); ++i )
+   {
+      result.splice( partitions[ i ] );
+   }
+}
+
+} // namespace wordindex
+
+#endif // merge_h_included
+
+/*
+ * end of file
+ */
@@ -14,13 +14,32 @@ PRGVER  = src/version.h
 PRGSRC  = src/main.cpp
 
 PRGHDR  = src/Config.h \
+		  src/MappedFile.h \
 		  src/Utility.h \
 		  src/Tokenizer.h \
+		  src/ScanKernel.h \
+		  src/Parallel.h \
+		  src/Merge.h \
+		  src/Hash.h \
+		  src/TokenView.h \
+		  src/Dictionary.h \
+		  src/Postings.h \
+		  src/KeywordSet.h \
+		  src/StopwordTable.h \
+		  src/Stopwords.h \
+		  src/StopwordFile.h \
+		  src/KeywordScanner.h \
+		  src/BlockReader.h \
+		  src/FileLoader.h \
+		  src/OutputBuffer.h \
+		  src/IndexFile.h \
+		  src/Query.h \
+		  src/WordTrie.h \
 		  $(PRGVER)
 
 PRGOBJ  = $(PRGSRC:.cpp=.o)
 
-PRGLIB  =
+PRGLIB  = -pthread
 
 #
 # end of file
@@ -0,0 +1,427 @@
+/*
+ * OutputBuffer.h - buffered output with fast number formatting.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef outputbuffer_h_included
+#define outputbuffer_h_included
+
+#include "Utility.h"    // for class UnCopyable
+
+#include <algorithm>    // for std::copy(), std::fill_n()
+#include <cmath>        // for std::floor(), std::fabs()
+#include <cstddef>      // for std::size_t
+#include <cstdio>       // for snprintf()
+#include <cstring>      // for std::strlen()
+#include <deque>        // for std::deque<>
+#include <ostream>      // for std::ostream
+#include <string>       // for std::string
+#include <vector>       // for std::vector<>
+
+#ifndef _WIN32
+# include <cerrno>      // for errno, EINTR
+# include <climits>     // for IOV_MAX
+# include <sys/uio.h>   // for writev()
+#endif
+
+namespace wordindex {
+
+/**
+ * collect output text in a large buffer that is written to a stream when
+ * full, or kept in memory when there is no stream. Numbers are formatted by
+ * hand and padded to a field width, with the same result as iostream
+ * formatting with std::right, but without its per-item overhead.
+ */
+class OutputBuffer : private UnCopyable
+{
+public:
+   /**
+    * the size type.
+    */
+   typedef std::size_t size_type;
+
+   /**
+    * the default buffer size.
+    */
+   enum { default_capacity = 1 << 20 };
+
+   /**
+    * constructor; collect the output in memory, see data().
+    */
+   OutputBuffer()
+   : m_os( NULL )
+   , m_capacity( 0 )
+   {
+      ;
+   }
+
+   /**
+    * constructor; write the output to the given stream in blocks of the given size.
+    */
+   explicit OutputBuffer( std::ostream& os, size_type const capacity = default_capacity )
+   : m_os( &os )
+   , m_capacity( capacity )
+   {
+      m_buffer.reserve( capacity );
+   }
+
+   /**
+    * destructor; write the remaining output.
+    */
+   ~OutputBuffer()
+   {
+      flush();
+   }
+
+   /**
+    * begin of output collected.
+    */
+   char const* data() const
+   {
+      return m_buffer.empty() ? NULL : &m_buffer[ 0 ];
+   }
+
+   /**
+    * number of characters collected.
+    */
+   const size_type size() const
+   {
+      return m_buffer.size();
+   }
+
+   /**
+    * discard the output collected.
+    */
+   void clear()
+   {
+      m_buffer.clear();
+   }
+
+   /**
+    * write the output collected to the stream, if any, and flush the stream.
+    */
+   void flush()
+   {
+      if ( m_os )
+      {
+         write_out();
+         m_os->flush();
+      }
+   }
+
+   /**
+    * append a character.
+    */
+   void put( char const chr )
+   {
+      m_buffer.push_back( chr );
+      check();
+   }
+
+   /**
+    * append the given number of copies of a character.
+    */
+   void put( size_type const count, char const chr )
+   {
+      m_buffer.insert( m_buffer.end(), count, chr );
+      check();
+   }
+
+   /**
+    * append characters [first, last).
+    */
+   void write( char const* first, char const* last )
+   {
+      m_buffer.insert( m_buffer.end(), first, last );
+      check();
+   }
+
+   /**
+    * append a string.
+    */
+   void write( std::string const& text )
+   {
+      write( text.data(), text.data() + text.size() );
+   }
+
+   /**
+    * append a C-string.
+    */
+   void write( char const* text )
+   {
+      write( text, text + std::strlen( text ) );
+   }
+
+   /**
+    * append characters [first, last) right-aligned in a field of the given width.
+    */
+   void write( char const* first, char const* last, int const width )
+   {
+      pad( last - first, width );
+      write( first, last );
+   }
+
+   /**
+    * append a string right-aligned in a field of the given width.
+    */
+   void write( std::string const& text, int const width )
+   {
+      write( text.data(), text.data() + text.size(), width );
+   }
+
+   /**
+    * append an integer right-aligned in a field of the given width.
+    */
+   template < typename T >
+   void write_integer( T const value, int const width = 0 )
+   {
+      char digits[ max_digits ];
+      char* const last = digits + max_digits;
+
+      write( format_integer( value, last ), last, width );
+   }
+
+   /**
+    * append a number in fixed notation with the given number of decimals,
+    * right-aligned in a field of the given width; as printf( "%.*f" ).
+    */
+   void write_fixed( double const value, int const precision, int const width = 0 )
+   {
+      char text[ max_digits + 2 * max_precision ];
+
+      int const length = format_fixed( value, precision, text, sizeof text );
+
+      if ( length < static_cast< int >( sizeof text ) )
+      {
+         write( text, text + length, width );
+      }
+      else
+      {
+         std::vector< char > large( length + 1 );
+         format_fixed( value, precision, &large[ 0 ], large.size() );
+         write( &large[ 0 ], &large[ 0 ] + length, width );
+      }
+   }
+
+   /**
+    * the text of a number in fixed notation with the given number of decimals;
+    * return its length, which, as with snprintf(), may exceed the given size.
+    */
+   static int format_fixed( double const value, int const precision, char* const text, size_type const size )
+   {
+      static double const scales[ max_precision + 1 ] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+      /*
+       * the scaled value rounded to an integer, except where that differs
+       * from rounding the exact decimal value, near a half; let snprintf()
+       * handle those and values beyond the fast range:
+       */
+      if ( 0 <= value && value < 1e9 && 0 <= precision && precision <= max_precision )
+      {
+         double const scaled   = value * scales[ precision ];
+         double const fraction = scaled - std::floor( scaled );
+
+         if ( scaled < 1e15 && std::fabs( fraction - 0.5 ) > 1e-6 )
+         {
+            unsigned long long const number = static_cast< unsigned long long >( std::floor( scaled + 0.5 ) );
+            unsigned long long const scale  = static_cast< unsigned long long >( scales[ precision ] );
+
+            char digits[ max_digits ];
+            char* const last  = digits + max_digits;
+            char* const first = format_integer( number / scale, last );
+
+            char* pos = std::copy( first, last, text );
+
+            if ( precision > 0 )
+            {
+               *pos++ = '.';
+
+               char* const decimals = format_integer( number % scale, last );
+
+               pos = std::fill_n( pos, precision - ( last - decimals ), '0' );
+               pos = std::copy( decimals, last, pos );
+            }
+            return static_cast< int >( pos - text );
+         }
+      }
+
+      return snprintf( text, size, "%.*f", precision, value );
+   }
+
+private:
+   /**
+    * the buffer space for a formatted integer or the integral part of a fixed number.
+    */
+   enum { max_digits = 24 };
+
+   /**
+    * the maximum number of decimals formatted without snprintf().
+    */
+   enum { max_precision = 9 };
+
+   /**
+    * format an integer backwards, ending at last; return the begin of its text.
+    */
+   template < typename T >
+   static char* format_integer( T const value, char* last )
+   {
+      bool const negative = value < 0;
+
+      // magnitude as unsigned, also for the most negative value:
+      unsigned long long number = negative ? 0ULL - static_cast< unsigned long long >( value ) : static_cast< unsigned long long >( value );
+
+      do
+      {
+         *--last = static_cast< char >( '0' + number % 10 );
+         number /= 10;
+      }
+      while ( number > 0 );
+
+      if ( negative )
+      {
+         *--last = '-';
+      }
+      return last;
+   }
+
+   /**
+    * append the padding for a text of the given length in a field of the given width.
+    */
+   void pad( std::ptrdiff_t const length, int const width )
+   {
+      if ( width > length )
+      {
+         m_buffer.insert( m_buffer.end(), static_cast< size_type >( width - length ), ' ' );
+      }
+   }
+
+   /**
+    * write the output collected to the stream if the buffer is full.
+    */
+   void check()
+   {
+      if ( m_os && m_buffer.size() >= m_capacity )
+      {
+         write_out();
+      }
+   }
+
+   /**
+    * write the output collected to the stream.
+    */
+   void write_out()
+   {
+      if ( !m_buffer.empty() )
+      {
+         m_os->write( &m_buffer[ 0 ], static_cast< std::streamsize >( m_buffer.size() ) );
+         m_buffer.clear();
+      }
+   }
+
+   /**
+    * the stream to write to; NULL to keep the output in memory.
+    */
+   std::ostream* m_os;
+
+   /**
+    * the buffer size at which the output is written.
+    */
+   size_type m_capacity;
+
+   /**
+    * the output collected.
+    */
+   std::vector< char > m_buffer;
+};
+
+/**
+ * write the output collected in the given buffers to the stream, in order.
+ */
+inline void write_buffers( std::ostream& os, std::deque< OutputBuffer > const& buffers )
+{
+   for ( std::deque< OutputBuffer >::const_iterator pos = buffers.begin(); pos != buffers.end(); ++pos )
+   {
+      if ( pos->size() > 0 )
+      {
+         os.write( pos->data(), static_cast< std::streamsize >( pos->size() ) );
+      }
+   }
+}
+
+#ifndef _WIN32
+/**
+ * write the output collected in the given buffers to the given file
+ * descriptor, in order, gathered by writev(); false on error.
+ */
+inline const bool write_buffers( int const fd, std::deque< OutputBuffer > const& buffers )
+{
+   std::vector< iovec > iov;
+
+   for ( std::deque< OutputBuffer >::const_iterator pos = buffers.begin(); pos != buffers.end(); ++pos )
+   {
+      if ( pos->size() > 0 )
+      {
+         iovec const vec = { const_cast< char* >( pos->data() ), pos->size() };
+         iov.push_back( vec );
+      }
+   }
+
+   for ( std::size_t first = 0; first < iov.size(); )
+   {
+      ssize_t written = writev( fd, &iov[ first ], static_cast< int >( std::min< std::size_t >( IOV_MAX, iov.size() - first ) ) );
+
+      if ( written < 0 )
+      {
+         if ( EINTR == errno )
+         {
+            continue;
+         }
+         return false;
+      }
+
+      // skip the buffers written, continue a partly written one:
+      for ( ; first < iov.size() && static_cast< std::size_t >( written ) >= iov[ first ].iov_len; ++first )
+      {
+         written -= iov[ first ].iov_len;
+      }
+
+      if ( written > 0 )
+      {
+         iov[ first ].iov_base = static_cast< char* >( iov[ first ].iov_base ) + written;
+         iov[ first ].iov_len -= written;
+      }
+   }
+   return true;
+}
+#endif
+
+} // namespace wordindex
+
+#endif // outputbuffer_h_included
+
+/*
+ * end of file
+ */
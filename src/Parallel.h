@@ -0,0 +1,245 @@
+/*
+ * Parallel.h - helpers to divide work over threads.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef parallel_h_included
+#define parallel_h_included
+
+#include "ScanKernel.h" // for find_newline()
+#include "Utility.h"    // for class UnCopyable
+
+#include <algorithm>    // for std::sort()
+#include <cstddef>      // for std::size_t
+#include <deque>        // for std::deque<>
+#include <functional>   // for std::ref()
+#include <mutex>        // for std::mutex
+#include <thread>       // for std::thread
+#include <utility>      // for std::pair<>
+#include <vector>       // for std::vector
+
+namespace wordindex {
+
+/**
+ * the number of hardware threads, at least 1.
+ */
+inline const int hardware_threads()
+{
+   const unsigned int n = std::thread::hardware_concurrency();
+
+   return n > 0 ? static_cast< int >( n ) : 1;
+}
+
+/**
+ * divide [first, last) into at most count chunks that each end just after a
+ * newline (the last chunk ends at last); return the chunk boundaries, i.e.
+ * first, the end of each chunk and last.
+ */
+inline std::vector< char const* > split_lines( char const* first, char const* last, const int count )
+{
+   std::vector< char const* > bounds( 1, first );
+
+   const std::size_t size = last - first;
+
+   for ( int i = 1; i < count; ++i )
+   {
+      char const* const pos = first + size / count * i;
+
+      if ( pos <= bounds.back() )
+      {
+         continue;
+      }
+
+      char const* const end = find_newline( pos, last );
+
+      if ( end == last )
+      {
+         break;
+      }
+
+      bounds.push_back( end + 1 );
+   }
+
+   if ( bounds.back() != last )
+   {
+      bounds.push_back( last );
+   }
+
+   return bounds;
+}
+
+/**
+ * run the given function objects, each on its own thread, and wait for all to finish.
+ */
+template < typename F >
+void run_parallel( std::vector< F >& functions )
+{
+   std::vector< std::thread > threads;
+   threads.reserve( functions.size() );
+
+   for ( typename std::vector< F >::iterator pos = functions.begin(); pos != functions.end(); ++pos )
+   {
+      threads.push_back( std::thread( std::ref( *pos ) ) );
+   }
+
+   for ( std::vector< std::thread >::iterator pos = threads.begin(); pos != threads.end(); ++pos )
+   {
+      pos->join();
+   }
+}
+
+/**
+ * per-worker task queues with work stealing: a worker takes tasks from the
+ * front of its own queue and, once that is empty, steals from the back of
+ * another worker's queue. Tasks are numbered.
+ */
+class WorkQueues : private UnCopyable
+{
+public:
+   /**
+    * the task type.
+    */
+   typedef int task_type;
+
+   /**
+    * constructor.
+    */
+   explicit WorkQueues( const int workers )
+   : m_queues( workers )
+   {
+      ;
+   }
+
+   /**
+    * number of workers.
+    */
+   const int workers() const
+   {
+      return static_cast< int >( m_queues.size() );
+   }
+
+   /**
+    * add a task to the back of the given worker's queue.
+    */
+   void push( const int worker, const task_type task )
+   {
+      Queue& queue = m_queues[ worker ];
+      std::lock_guard< std::mutex > lock( queue.mutex );
+
+      queue.tasks.push_back( task );
+   }
+
+   /**
+    * take a task for the given worker; false if no tasks are left.
+    */
+   const bool pop( const int worker, task_type& task )
+   {
+      if ( take( worker, true, task ) )
+      {
+         return true;
+      }
+
+      for ( int i = 1; i < workers(); ++i )
+      {
+         if ( take( ( worker + i ) % workers(), false, task ) )
+         {
+            return true;
+         }
+      }
+      return false;
+   }
+
+private:
+   /**
+    * take a task from the front or the back of the given queue.
+    */
+   const bool take( const int worker, const bool front, task_type& task )
+   {
+      Queue& queue = m_queues[ worker ];
+      std::lock_guard< std::mutex > lock( queue.mutex );
+
+      if ( queue.tasks.empty() )
+      {
+         return false;
+      }
+
+      if ( front )
+      {
+         task = queue.tasks.front(); queue.tasks.pop_front();
+      }
+      else
+      {
+         task = queue.tasks.back(); queue.tasks.pop_back();
+      }
+      return true;
+   }
+
+   /**
+    * a worker's task queue.
+    */
+   struct Queue
+   {
+      std::mutex mutex;                 ///< protects tasks
+      std::deque< task_type > tasks;    ///< the tasks
+   };
+
+   /**
+    * the queues, one per worker.
+    */
+   std::deque< Queue > m_queues;
+};
+
+/**
+ * distribute tasks 0..n-1 with the given costs over the work queues,
+ * largest first, dealt round-robin so that each worker starts with the
+ * largest of its share and thieves take the smallest.
+ */
+template < typename T >
+void schedule_largest_first( WorkQueues& queues, std::vector< T > const& costs )
+{
+   std::vector< std::pair< T, int > > order;
+
+   for ( std::size_t i = 0; i < costs.size(); ++i )
+   {
+      order.push_back( std::make_pair( costs[ i ], -static_cast< int >( i ) ) );
+   }
+
+   // descending cost, ascending task number for equal costs:
+   std::sort( order.rbegin(), order.rend() );
+
+   for ( std::size_t i = 0; i < order.size(); ++i )
+   {
+      queues.push( static_cast< int >( i % queues.workers() ), -order[ i ].second );
+   }
+}
+
+} // namespace wordindex
+
+#endif // parallel_h_included
+
+/*
+ * end of file
+ */
@@ -0,0 +1,464 @@
+/*
+ * Postings.h - delta/varint compressed line number lists.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef postings_h_included
+#define postings_h_included
+
+#include <algorithm>    // for std::swap()
+#include <cstddef>      // for std::ptrdiff_t, std::size_t
+#include <iterator>     // for std::forward_iterator_tag
+#include <vector>       // for std::vector<>
+
+namespace wordindex {
+
+/**
+ * list of line numbers, stored as the differences between successive numbers,
+ * zigzag encoded so that a step back (e.g. to a next file) stays small, in
+ * variable-length bytes of seven bits each, least significant first; the high
+ * bit marks that more bytes follow. Line numbers are decoded when iterated.
+ */
+class Postings
+{
+public:
+   /**
+    * the line number type.
+    */
+   typedef int value_type;
+
+   /**
+    * the size type.
+    */
+   typedef std::size_t size_type;
+
+   /**
+    * the byte type.
+    */
+   typedef unsigned char byte_type;
+
+   /**
+    * const iterator that decodes the line numbers.
+    */
+   class const_iterator
+   {
+   public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef Postings::value_type      value_type;
+      typedef std::ptrdiff_t            difference_type;
+      typedef value_type const*         pointer;
+      typedef value_type const&         reference;
+
+      /**
+       * default constructor.
+       */
+      const_iterator()
+      : m_pos( NULL )
+      , m_next( NULL )
+      , m_end( NULL )
+      , m_value( 0 )
+      {
+      }
+
+      /**
+       * constructor; decode the line number at pos, unless at end; the first
+       * difference is relative to the given line number.
+       */
+      const_iterator( byte_type const* pos, byte_type const* end, value_type const base = 0 )
+      : m_pos( pos )
+      , m_next( pos )
+      , m_end( end )
+      , m_value( base )
+      {
+         decode();
+      }
+
+      /**
+       * the current line number.
+       */
+      reference operator*() const
+      {
+         return m_value;
+      }
+
+      /**
+       * advance to next line number.
+       */
+      const_iterator& operator++()
+      {
+         m_pos = m_next;
+         decode();
+         return *this;
+      }
+
+      /**
+       * advance to next line number.
+       */
+      const_iterator operator++( int )
+      {
+         const_iterator result( *this );
+         ++*this;
+         return result;
+      }
+
+      /**
+       * true if this and other iterators are equal.
+       */
+      const bool operator==( const_iterator const& rhs ) const
+      {
+         return m_pos == rhs.m_pos;
+      }
+
+      /**
+       * true if this and other iterators are unequal.
+       */
+      const bool operator!=( const_iterator const& rhs ) const
+      {
+         return m_pos != rhs.m_pos;
+      }
+
+   private:
+      /**
+       * decode the difference at m_pos, unless at end, and add it to the line number.
+       */
+      void decode()
+      {
+         if ( m_next != m_end )
+         {
+            m_value += Postings::decode( m_next );
+         }
+      }
+
+      byte_type const* m_pos;     ///< position of the current line number
+      byte_type const* m_next;    ///< position of the next line number
+      byte_type const* m_end;     ///< end of the list
+      value_type       m_value;   ///< the current line number
+   };
+
+   /**
+    * constructor.
+    */
+   Postings()
+   : m_bytes()
+   , m_last( 0 )
+   , m_count( 0 )
+   {
+      ;
+   }
+
+   /**
+    * const begin iterator.
+    */
+   const_iterator begin() const
+   {
+      return const_iterator( data(), data() + m_bytes.size() );
+   }
+
+   /**
+    * const end iterator.
+    */
+   const_iterator end() const
+   {
+      return const_iterator( data() + m_bytes.size(), data() + m_bytes.size() );
+   }
+
+   /**
+    * number of line numbers.
+    */
+   const size_type size() const
+   {
+      return m_count;
+   }
+
+   /**
+    * true if there are no line numbers.
+    */
+   const bool empty() const
+   {
+      return 0 == m_count;
+   }
+
+   /**
+    * the number of bytes used by the encoded line numbers.
+    */
+   const size_type encoded_size() const
+   {
+      return m_bytes.size();
+   }
+
+   /**
+    * the encoded line numbers, see encoded_size().
+    */
+   byte_type const* encoded_data() const
+   {
+      return data();
+   }
+
+   /**
+    * the last line number.
+    */
+   const value_type back() const
+   {
+      return m_last;
+   }
+
+   /**
+    * add a line number.
+    */
+   void push_back( value_type const line )
+   {
+      encode( line - m_last );
+
+      m_last = line;
+      ++m_count;
+   }
+
+   /**
+    * add the line numbers of other, with the given offset added.
+    * Only the first difference changes; the others are copied as is.
+    */
+   void append( Postings const& other, value_type const offset = 0 )
+   {
+      if ( other.empty() )
+      {
+         return;
+      }
+
+      byte_type const* pos = other.data();
+      value_type const first = decode( pos ) + offset;
+
+      encode( first - m_last );
+      m_bytes.insert( m_bytes.end(), pos, other.data() + other.m_bytes.size() );
+
+      m_last   = other.m_last + offset;
+      m_count += other.m_count;
+   }
+
+   /**
+    * exchange contents with other.
+    */
+   void swap( Postings& other )
+   {
+      m_bytes.swap( other.m_bytes );
+      std::swap( m_last , other.m_last  );
+      std::swap( m_count, other.m_count );
+   }
+
+private:
+   /**
+    * the encoded differences.
+    */
+   byte_type const* data() const
+   {
+      return m_bytes.empty() ? NULL : &m_bytes[ 0 ];
+   }
+
+   /**
+    * append the given difference.
+    */
+   void encode( value_type const delta )
+   {
+      unsigned int bits = ( static_cast< unsigned int >( delta ) << 1 ) ^ static_cast< unsigned int >( delta >> 31 );
+
+      while ( bits >= 0x80 )
+      {
+         m_bytes.push_back( static_cast< byte_type >( bits | 0x80 ) );
+         bits >>= 7;
+      }
+      m_bytes.push_back( static_cast< byte_type >( bits ) );
+   }
+
+   /**
+    * decode the difference at pos and advance pos past it.
+    */
+   static const value_type decode( byte_type const*& pos )
+   {
+      unsigned int bits = 0;
+
+      for ( int shift = 0; ; shift += 7 )
+      {
+         byte_type const byte = *pos++;
+
+         bits |= static_cast< unsigned int >( byte & 0x7F ) << shift;
+
+         if ( 0 == ( byte & 0x80 ) )
+         {
+            break;
+         }
+      }
+      return static_cast< value_type >( bits >> 1 ) ^ -static_cast< value_type >( bits & 1 );
+   }
+
+   /**
+    * the encoded differences.
+    */
+   std::vector< byte_type > m_bytes;
+
+   /**
+    * the last line number, for the next difference.
+    */
+   value_type m_last;
+
+   /**
+    * the number of line numbers.
+    */
+   unsigned int m_count;
+};
+
+/**
+ * read-only view of line numbers encoded as by Postings, e.g. in a mapped index file.
+ */
+class PostingsView
+{
+public:
+   /**
+    * the line number type.
+    */
+   typedef Postings::value_type value_type;
+
+   /**
+    * the size type.
+    */
+   typedef Postings::size_type size_type;
+
+   /**
+    * the byte type.
+    */
+   typedef Postings::byte_type byte_type;
+
+   /**
+    * the const iterator type.
+    */
+   typedef Postings::const_iterator const_iterator;
+
+   /**
+    * default constructor; no line numbers.
+    */
+   PostingsView()
+   : m_first( NULL )
+   , m_last( NULL )
+   , m_count( 0 )
+   , m_base( 0 )
+   {
+      ;
+   }
+
+   /**
+    * constructor; the given number of line numbers encoded in [first, last),
+    * the first relative to the given line number, e.g. for the part of a
+    * longer list that follows that line number.
+    */
+   PostingsView( byte_type const* first, byte_type const* last, size_type const count, value_type const base = 0 )
+   : m_first( first )
+   , m_last( last )
+   , m_count( count )
+   , m_base( base )
+   {
+      ;
+   }
+
+   /**
+    * const begin iterator.
+    */
+   const_iterator begin() const
+   {
+      return const_iterator( m_first, m_last, m_base );
+   }
+
+   /**
+    * const end iterator.
+    */
+   const_iterator end() const
+   {
+      return const_iterator( m_last, m_last );
+   }
+
+   /**
+    * number of line numbers.
+    */
+   const size_type size() const
+   {
+      return m_count;
+   }
+
+   /**
+    * true if there are no line numbers.
+    */
+   const bool empty() const
+   {
+      return 0 == m_count;
+   }
+
+private:
+   byte_type const* m_first;   ///< begin of encoded line numbers
+   byte_type const* m_last;    ///< end of encoded line numbers
+   size_type        m_count;   ///< number of line numbers
+   value_type       m_base;    ///< the line number the first difference is relative to
+};
+
+/**
+ * append the given number to bytes in variable-length bytes of seven bits
+ * each, least significant first, like the differences of class Postings.
+ */
+inline void encode_number( std::vector< Postings::byte_type >& bytes, unsigned long long number )
+{
+   while ( number >= 0x80 )
+   {
+      bytes.push_back( static_cast< Postings::byte_type >( number | 0x80 ) );
+      number >>= 7;
+   }
+   bytes.push_back( static_cast< Postings::byte_type >( number ) );
+}
+
+/**
+ * decode the number at pos, see encode_number(), and advance pos past it;
+ * false if the number does not end before end.
+ */
+inline const bool decode_number( Postings::byte_type const*& pos, Postings::byte_type const* end, unsigned long long& number )
+{
+   number = 0;
+
+   for ( int shift = 0; pos != end && shift < 64; shift += 7 )
+   {
+      Postings::byte_type const byte = *pos++;
+
+      number |= static_cast< unsigned long long >( byte & 0x7F ) << shift;
+
+      if ( 0 == ( byte & 0x80 ) )
+      {
+         return true;
+      }
+   }
+   return false;
+}
+
+} // namespace wordindex
+
+#endif // postings_h_included
+
+/*
+ * end of file
+ */
@@ -0,0 +1,504 @@
+/*
+ * Query.h - boolean word queries and the set operations they are evaluated with.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef query_h_included
+#define query_h_included
+
+#include "Tokenizer.h"  // for class RangeTokenizer
+
+#include <algorithm>    // for std::lower_bound(), std::set_union(), std::unique()
+#include <cctype>       // for isspace()
+#include <cstddef>      // for std::size_t
+#include <deque>        // for std::deque<>
+#include <iterator>     // for std::back_inserter()
+#include <string>       // for std::string
+#include <vector>       // for std::vector<>
+
+namespace wordindex {
+
+/**
+ * the location type: file number in the high, line number in the low 32 bits,
+ * so that locations order by (file, line).
+ */
+typedef unsigned long long location_type;
+
+/**
+ * the sorted list of locations type.
+ */
+typedef std::vector< location_type > locations_type;
+
+/**
+ * the location of the given line in the given file.
+ */
+inline const location_type location( std::size_t const file, int const line )
+{
+   return ( static_cast< location_type >( file ) << 32 ) | static_cast< unsigned int >( line );
+}
+
+/**
+ * the line number of the given location.
+ */
+inline const int line_of( location_type const location )
+{
+   return static_cast< int >( location & 0xFFFFFFFFu );
+}
+
+/**
+ * size ratio of two lists from which on the longer list is searched
+ * (galloping) rather than walked alongside the shorter one.
+ */
+std::size_t const gallop_ratio = 16;
+
+/**
+ * the first position in [first, last) not less than value: probe 1, 2, 4, ...
+ * elements ahead, then binary search the last step; cheap when the value is near.
+ */
+inline locations_type::const_iterator gallop( locations_type::const_iterator first, locations_type::const_iterator const last, location_type const value )
+{
+   std::size_t step = 1;
+   std::size_t const size = last - first;
+
+   std::size_t lower = 0;
+   std::size_t upper = 1;
+
+   while ( upper < size && first[ upper - 1 ] < value )
+   {
+      lower = upper;
+      step *= 2;
+      upper = lower + step;
+   }
+
+   return std::lower_bound( first + lower, first + std::min( upper, size ), value );
+}
+
+/**
+ * the locations in both sorted lists a and b.
+ */
+inline void intersect( locations_type const& a, locations_type const& b, locations_type& result )
+{
+   result.clear();
+
+   locations_type const& small = a.size() <= b.size() ? a : b;
+   locations_type const& large = a.size() <= b.size() ? b : a;
+
+   locations_type::const_iterator pos = large.begin();
+
+   if ( large.size() / gallop_ratio >= small.size() )
+   {
+      for ( locations_type::const_iterator value = small.begin(); value != small.end() && pos != large.end(); ++value )
+      {
+         pos = gallop( pos, large.end(), *value );
+
+         if ( pos != large.end() && *pos == *value )
+         {
+            result.push_back( *value );
+         }
+      }
+      return;
+   }
+
+   locations_type::const_iterator value = small.begin();
+
+   while ( value != small.end() && pos != large.end() )
+   {
+      // advance the smaller of the two, both on equality:
+      location_type const x = *value;
+      location_type const y = *pos;
+
+      if ( x == y )
+      {
+         result.push_back( x );
+      }
+
+      value += x <= y;
+      pos   += y <= x;
+   }
+}
+
+/**
+ * the locations in sorted list a or b.
+ */
+inline void unite( locations_type const& a, locations_type const& b, locations_type& result )
+{
+   result.clear();
+   result.reserve( a.size() + b.size() );
+
+   std::set_union( a.begin(), a.end(), b.begin(), b.end(), std::back_inserter( result ) );
+}
+
+/**
+ * the locations in sorted list a that are not in b.
+ */
+inline void subtract( locations_type const& a, locations_type const& b, locations_type& result )
+{
+   result.clear();
+
+   bool const search = b.size() / gallop_ratio >= a.size();
+
+   locations_type::const_iterator pos = b.begin();
+
+   for ( locations_type::const_iterator value = a.begin(); value != a.end(); ++value )
+   {
+      if ( search )
+      {
+         pos = gallop( pos, b.end(), *value );
+      }
+      else
+      {
+         while ( pos != b.end() && *pos < *value )
+         {
+            ++pos;
+         }
+      }
+
+      if ( pos == b.end() || *pos != *value )
+      {
+         result.push_back( *value );
+      }
+   }
+}
+
+/**
+ * boolean query on words, such as: foo AND ( bar OR baz ) NOT qux.
+ *
+ * The operators are NOT (also AND NOT), AND and OR, in order of decreasing
+ * precedence, and parentheses group. The operators are written in uppercase;
+ * any other text separated by whitespace or parentheses is a word. As there
+ * are no all-lines, NOT only excludes from what is on its left.
+ *
+ * The query is compiled into postfix instructions; evaluate() runs them on
+ * the sorted locations of the words.
+ */
+class BooleanQuery
+{
+public:
+   /**
+    * the list of words type.
+    */
+   typedef std::vector< std::string > words_type;
+
+   /**
+    * constructor; compile the given expression, see is_valid(); words are
+    * read as the text they are found in, converted to lowercase if so requested.
+    */
+   explicit BooleanQuery( std::string const& expression, bool const lowercase = false )
+   : m_expression( expression )
+   , m_lowercase( lowercase )
+   {
+      compile();
+   }
+
+   /**
+    * the expression.
+    */
+   std::string const& expression() const
+   {
+      return m_expression;
+   }
+
+   /**
+    * true if the expression is well-formed.
+    */
+   const bool is_valid() const
+   {
+      return m_error.empty();
+   }
+
+   /**
+    * what is wrong with the expression; empty if it is well-formed.
+    */
+   std::string const& error() const
+   {
+      return m_error;
+   }
+
+   /**
+    * the words of the query, in order of appearance.
+    */
+   words_type words() const
+   {
+      words_type result;
+
+      for ( program_type::const_iterator pos = m_program.begin(); pos != m_program.end(); ++pos )
+      {
+         if ( op_word == pos->op )
+         {
+            result.push_back( pos->word );
+         }
+      }
+      return result;
+   }
+
+   /**
+    * the locations that satisfy the query; lookup( word ) gives the sorted
+    * distinct locations of a word, which must stay valid while evaluating.
+    * The lists of words are only read, so that lookup can keep them between
+    * queries; intermediate results are the only lists made.
+    */
+   template < typename L >
+   void evaluate( L& lookup, locations_type& result ) const
+   {
+      std::vector< locations_type const* > stack;
+      std::deque< locations_type > owned;   // keeps its elements in place
+
+      for ( program_type::const_iterator pos = m_program.begin(); pos != m_program.end(); ++pos )
+      {
+         if ( op_word == pos->op )
+         {
+            stack.push_back( &lookup( pos->word ) );
+            continue;
+         }
+
+         locations_type const& a = *stack[ stack.size() - 2 ];
+         locations_type const& b = *stack[ stack.size() - 1 ];
+
+         owned.push_back( locations_type() );
+
+         switch ( pos->op )
+         {
+            case op_and: intersect( a, b, owned.back() ); break;
+            case op_or : unite    ( a, b, owned.back() ); break;
+            default    : subtract ( a, b, owned.back() ); break;
+         }
+
+         stack.pop_back();
+         stack.back() = &owned.back();
+      }
+
+      result.clear();
+
+      if ( !stack.empty() )
+      {
+         if ( !owned.empty() && &owned.back() == stack.back() )
+         {
+            result.swap( owned.back() );
+         }
+         else
+         {
+            result = *stack.back();
+         }
+      }
+   }
+
+private:
+   /**
+    * the instruction type.
+    */
+   enum op_type { op_word, op_and, op_or, op_not };
+
+   /**
+    * an instruction: push the locations of a word, or combine the top two.
+    */
+   struct Instruction
+   {
+      Instruction( op_type const o, std::string const& w = "" ) : op( o ), word( w ) { ; }
+
+      op_type     op;     ///< the operation
+      std::string word;   ///< the word, for op_word
+   };
+
+   /**
+    * the program type.
+    */
+   typedef std::vector< Instruction > program_type;
+
+   /**
+    * split the expression into words, operators and parentheses, and parse it.
+    */
+   void compile()
+   {
+      std::string token;
+
+      for ( std::string::const_iterator pos = m_expression.begin(); ; ++pos )
+      {
+         bool const end = pos == m_expression.end();
+
+         if ( end || isspace( static_cast< unsigned char >( *pos ) ) || '(' == *pos || ')' == *pos )
+         {
+            if ( !token.empty() )
+            {
+               m_tokens.push_back( token );
+               token.erase();
+            }
+
+            if ( end )
+            {
+               break;
+            }
+
+            if ( '(' == *pos || ')' == *pos )
+            {
+               m_tokens.push_back( std::string( 1, *pos ) );
+            }
+            continue;
+         }
+         token += *pos;
+      }
+
+      m_next = 0;
+
+      parse_or();
+
+      if ( m_error.empty() && m_next < m_tokens.size() )
+      {
+         m_error = "unexpected '" + m_tokens[ m_next ] + "'";
+      }
+   }
+
+   /**
+    * true if the next token is the given one; if so, skip it.
+    */
+   const bool accept( char const* const token )
+   {
+      if ( m_next < m_tokens.size() && token == m_tokens[ m_next ] )
+      {
+         ++m_next;
+         return true;
+      }
+      return false;
+   }
+
+   /**
+    * or-expression: and-expression { OR and-expression }.
+    */
+   void parse_or()
+   {
+      parse_and();
+
+      while ( m_error.empty() && accept( "OR" ) )
+      {
+         parse_and();
+         m_program.push_back( Instruction( op_or ) );
+      }
+   }
+
+   /**
+    * and-expression: term { AND term | AND NOT term | NOT term }.
+    */
+   void parse_and()
+   {
+      parse_term();
+
+      while ( m_error.empty() )
+      {
+         op_type op = op_and;
+
+         if ( accept( "AND" ) )
+         {
+            op = accept( "NOT" ) ? op_not : op_and;
+         }
+         else if ( accept( "NOT" ) )
+         {
+            op = op_not;
+         }
+         else
+         {
+            return;
+         }
+
+         parse_term();
+         m_program.push_back( Instruction( op ) );
+      }
+   }
+
+   /**
+    * term: word | ( or-expression ).
+    */
+   void parse_term()
+   {
+      if ( m_next >= m_tokens.size() )
+      {
+         m_error = "missing word at end";
+         return;
+      }
+
+      if ( accept( "(" ) )
+      {
+         parse_or();
+
+         if ( m_error.empty() && !accept( ")" ) )
+         {
+            m_error = "missing ')'";
+         }
+         return;
+      }
+
+      std::string const& token = m_tokens[ m_next ];
+
+      if ( ")" == token || "AND" == token || "OR" == token || "NOT" == token )
+      {
+         m_error = "missing word before '" + token + "'";
+         return;
+      }
+
+      std::string word;
+
+      if ( !read_word( token, word ) )
+      {
+         m_error = "'" + token + "' is not one word of the text";
+         return;
+      }
+
+      m_program.push_back( Instruction( op_word, word ) );
+      ++m_next;
+   }
+
+   /**
+    * the given token as the tokenizer reads it from text, in lowercase if so
+    * requested; false if it reads no word or several, such as 'foo-bar'.
+    */
+   const bool read_word( std::string const& token, std::string& word ) const
+   {
+      RangeTokenizer tokenizer( token.data(), token.data() + token.size() );
+      tokenizer.set_lowercase( m_lowercase );
+
+      std::size_t words = 0;
+
+      for ( RangeTokenizer::iterator pos = tokenizer.begin(); pos != tokenizer.end(); ++pos, ++words )
+      {
+         word = (*pos).first.str();
+      }
+
+      return 1 == words && word.size() == token.size();
+   }
+
+   std::string  m_expression;          ///< the query
+   bool         m_lowercase;           ///< convert words to lowercase
+   std::string  m_error;               ///< what is wrong with the query
+   program_type m_program;             ///< the compiled query
+   std::vector< std::string > m_tokens;  ///< the tokens of the query, while compiling
+   std::size_t  m_next;                ///< the next token, while compiling
+};
+
+} // namespace wordindex
+
+#endif // query_h_included
+
+/*
+ * end of file
+ */
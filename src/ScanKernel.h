@@ -0,0 +1,543 @@
+/*
+ * ScanKernel.h - SSE2/AVX2 scanning kernels for the tokenizer.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef scankernel_h_included
+#define scankernel_h_included
+
+#include "Config.h"     // for _WORDINDEX_HAVE_SSE2, _WORDINDEX_HAVE_AVX2
+
+#include <cstddef>      // for std::size_t
+
+#if defined( _WORDINDEX_HAVE_SSE2 )
+# include <emmintrin.h> // for SSE2 intrinsics
+#endif
+
+#if defined( _WORDINDEX_HAVE_AVX2 )
+# include <immintrin.h> // for AVX2 intrinsics
+#endif
+
+#if defined( _WORDINDEX_MSC )
+# include <intrin.h>    // for _BitScanForward()
+#endif
+
+namespace wordindex {
+
+/**
+ * number of set bits.
+ */
+inline const int popcount( unsigned int x )
+{
+#if defined( _WORDINDEX_GNU )
+   return __builtin_popcount( x );
+#else
+   x = x - ( ( x >> 1 ) & 0x55555555u );
+   x = ( x & 0x33333333u ) + ( ( x >> 2 ) & 0x33333333u );
+   return ( ( ( x + ( x >> 4 ) ) & 0x0F0F0F0Fu ) * 0x01010101u ) >> 24;
+#endif
+}
+
+/**
+ * index of lowest set bit; x must be non-zero.
+ */
+inline const int lowest_bit( unsigned int x )
+{
+#if defined( _WORDINDEX_GNU )
+   return __builtin_ctz( x );
+#elif defined( _WORDINDEX_MSC )
+   unsigned long index;
+   _BitScanForward( &index, x );
+   return index;
+#else
+   int n = 0;
+   while ( 0 == ( x & 1 ) ) { x >>= 1; ++n; }
+   return n;
+#endif
+}
+
+/**
+ * set of byte values in a form the vector kernels can test: the letters
+ * [A-Za-z] and the digits [0-9] as a block each, plus a few single bytes.
+ * Sets that do not fit this form are scanned a byte at a time.
+ */
+class ByteSet
+{
+public:
+   /**
+    * the maximum number of single bytes.
+    */
+   enum { max_bytes = 8 };
+
+   /**
+    * constructor; the bytes whose entry in the 256-entry class table has any of the bits in mask.
+    */
+   ByteSet( unsigned char const* table, const int mask )
+   {
+      for ( int i = 0; i < table_size; ++i )
+      {
+         m_table[ i ] = 0 != ( table[ i ] & mask );
+      }
+      update();
+   }
+
+   /**
+    * true if the given byte is a member of the set.
+    */
+   const bool contains( const char chr ) const
+   {
+      return m_table[ static_cast< unsigned char >( chr ) ];
+   }
+
+   /**
+    * true if the set can be tested by the vector kernels.
+    */
+   const bool is_vectorizable() const
+   {
+      return m_vector;
+   }
+
+   /**
+    * true if the letters block is part of the set.
+    */
+   const bool has_letters() const
+   {
+      return m_letters;
+   }
+
+   /**
+    * true if the digits block is part of the set.
+    */
+   const bool has_digits() const
+   {
+      return m_digits;
+   }
+
+   /**
+    * number of single bytes.
+    */
+   const int count() const
+   {
+      return m_count;
+   }
+
+   /**
+    * the i-th single byte.
+    */
+   const unsigned char byte( const int i ) const
+   {
+      return m_bytes[ i ];
+   }
+
+private:
+   /**
+    * true if all bytes in [first, last] are members.
+    */
+   const bool all_of( const int first, const int last ) const
+   {
+      for ( int i = first; i <= last; ++i )
+      {
+         if ( !m_table[ i ] ) return false;
+      }
+      return true;
+   }
+
+   /**
+    * recompute the block and single-byte representation.
+    */
+   void update()
+   {
+      m_letters = all_of( 'A', 'Z' ) && all_of( 'a', 'z' );
+      m_digits  = all_of( '0', '9' );
+      m_count   = 0;
+      m_vector  = true;
+
+      for ( int i = 0; i < table_size; ++i )
+      {
+         const bool letter = ( 'A' <= i && i <= 'Z' ) || ( 'a' <= i && i <= 'z' );
+         const bool digit  = ( '0' <= i && i <= '9' );
+
+         if ( !m_table[ i ] || ( letter && m_letters ) || ( digit && m_digits ) )
+         {
+            continue;
+         }
+
+         if ( m_count == max_bytes )
+         {
+            m_vector = false;
+            return;
+         }
+
+         m_bytes[ m_count++ ] = static_cast< unsigned char >( i );
+      }
+   }
+
+   /**
+    * the number of byte values.
+    */
+   enum { table_size = 256 };
+
+   bool m_table[ table_size ];          ///< membership per byte value
+   bool m_letters;                      ///< [A-Za-z] are members
+   bool m_digits;                       ///< [0-9] are members
+   int  m_count;                        ///< number of single bytes
+   unsigned char m_bytes[ max_bytes ];  ///< single bytes
+   bool m_vector;                       ///< set fits vector representation
+};
+
+/**
+ * \name Scalar kernels
+ * @{
+ */
+
+/**
+ * first position in [first, last) with a byte in set (or not in set if negate);
+ * add the number of newlines before that position to newlines.
+ */
+inline char const* scan_scalar( char const* first, char const* last, ByteSet const& set, const bool negate, long& newlines )
+{
+   for ( ; first != last; ++first )
+   {
+      if ( negate != set.contains( *first ) )
+      {
+         break;
+      }
+      newlines += ( '\n' == *first );
+   }
+   return first;
+}
+
+/// @}
+
+#if defined( _WORDINDEX_HAVE_SSE2 )
+
+/**
+ * \name SSE2 kernels (16 bytes per step)
+ * @{
+ */
+
+/**
+ * mask of bytes in v that are in [lo, lo+n].
+ */
+inline __m128i in_range_sse2( __m128i v, const char lo, const char n )
+{
+   __m128i const t = _mm_sub_epi8( v, _mm_set1_epi8( lo ) );
+   return _mm_cmpeq_epi8( _mm_min_epu8( t, _mm_set1_epi8( n ) ), t );
+}
+
+/**
+ * bit mask of the bytes in v that are members of set.
+ */
+inline const unsigned int match_sse2( ByteSet const& set, __m128i v )
+{
+   __m128i m = _mm_setzero_si128();
+
+   if ( set.has_letters() )
+   {
+      m = _mm_or_si128( m, in_range_sse2( _mm_or_si128( v, _mm_set1_epi8( 0x20 ) ), 'a', 'z' - 'a' ) );
+   }
+   if ( set.has_digits() )
+   {
+      m = _mm_or_si128( m, in_range_sse2( v, '0', '9' - '0' ) );
+   }
+   for ( int i = 0; i < set.count(); ++i )
+   {
+      m = _mm_or_si128( m, _mm_cmpeq_epi8( v, _mm_set1_epi8( set.byte( i ) ) ) );
+   }
+   return _mm_movemask_epi8( m );
+}
+
+/**
+ * SSE2 version of scan_scalar().
+ */
+inline char const* scan_sse2( char const* first, char const* last, ByteSet const& set, const bool negate, long& newlines )
+{
+   __m128i const nl = _mm_set1_epi8( '\n' );
+   unsigned int const flip = negate ? 0xFFFFu : 0u;
+
+   for ( ; last - first >= 16; first += 16 )
+   {
+      __m128i const v = _mm_loadu_si128( reinterpret_cast< __m128i const* >( first ) );
+
+      unsigned int const hit   = match_sse2( set, v ) ^ flip;
+      unsigned int const lines = _mm_movemask_epi8( _mm_cmpeq_epi8( v, nl ) );
+
+      if ( hit )
+      {
+         int const n = lowest_bit( hit );
+         newlines += popcount( lines & ( ( 1u << n ) - 1 ) );
+         return first + n;
+      }
+      newlines += popcount( lines );
+   }
+   return scan_scalar( first, last, set, negate, newlines );
+}
+
+/**
+ * first newline in [first, last), or last.
+ */
+inline char const* find_newline_sse2( char const* first, char const* last )
+{
+   __m128i const nl = _mm_set1_epi8( '\n' );
+
+   for ( ; last - first >= 16; first += 16 )
+   {
+      unsigned int const hit = _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128( reinterpret_cast< __m128i const* >( first ) ), nl ) );
+
+      if ( hit )
+      {
+         return first + lowest_bit( hit );
+      }
+   }
+   for ( ; first != last && '\n' != *first; ++first )
+   {
+      ;
+   }
+   return first;
+}
+
+/**
+ * number of newlines in [first, last).
+ */
+inline const long count_newlines_sse2( char const* first, char const* last )
+{
+   __m128i const nl = _mm_set1_epi8( '\n' );
+   long count = 0;
+
+   for ( ; last - first >= 16; first += 16 )
+   {
+      count += popcount( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128( reinterpret_cast< __m128i const* >( first ) ), nl ) ) );
+   }
+   for ( ; first != last; ++first )
+   {
+      count += ( '\n' == *first );
+   }
+   return count;
+}
+
+/// @}
+
+#endif // _WORDINDEX_HAVE_SSE2
+
+#if defined( _WORDINDEX_HAVE_AVX2 )
+
+/**
+ * \name AVX2 kernels (32 bytes per step), selected at runtime
+ * @{
+ */
+
+/**
+ * true if the processor supports AVX2.
+ */
+inline const bool have_avx2()
+{
+   static const bool avx2 = __builtin_cpu_supports( "avx2" );
+   return avx2;
+}
+
+/**
+ * mask of bytes in v that are in [lo, lo+n].
+ */
+__attribute__(( target( "avx2" ) ))
+inline __m256i in_range_avx2( __m256i v, const char lo, const char n )
+{
+   __m256i const t = _mm256_sub_epi8( v, _mm256_set1_epi8( lo ) );
+   return _mm256_cmpeq_epi8( _mm256_min_epu8( t, _mm256_set1_epi8( n ) ), t );
+}
+
+/**
+ * bit mask of the bytes in v that are members of set.
+ */
+__attribute__(( target( "avx2" ) ))
+inline const unsigned int match_avx2( ByteSet const& set, __m256i v )
+{
+   __m256i m = _mm256_setzero_si256();
+
+   if ( set.has_letters() )
+   {
+      m = _mm256_or_si256( m, in_range_avx2( _mm256_or_si256( v, _mm256_set1_epi8( 0x20 ) ), 'a', 'z' - 'a' ) );
+   }
+   if ( set.has_digits() )
+   {
+      m = _mm256_or_si256( m, in_range_avx2( v, '0', '9' - '0' ) );
+   }
+   for ( int i = 0; i < set.count(); ++i )
+   {
+      m = _mm256_or_si256( m, _mm256_cmpeq_epi8( v, _mm256_set1_epi8( set.byte( i ) ) ) );
+   }
+   return _mm256_movemask_epi8( m );
+}
+
+/**
+ * AVX2 version of scan_scalar().
+ */
+__attribute__(( target( "avx2" ) ))
+inline char const* scan_avx2( char const* first, char const* last, ByteSet const& set, const bool negate, long& newlines )
+{
+   __m256i const nl = _mm256_set1_epi8( '\n' );
+   unsigned int const flip = negate ? 0xFFFFFFFFu : 0u;
+
+   for ( ; last - first >= 32; first += 32 )
+   {
+      __m256i const v = _mm256_loadu_si256( reinterpret_cast< __m256i const* >( first ) );
+
+      unsigned int const hit   = match_avx2( set, v ) ^ flip;
+      unsigned int const lines = _mm256_movemask_epi8( _mm256_cmpeq_epi8( v, nl ) );
+
+      if ( hit )
+      {
+         int const n = lowest_bit( hit );
+         newlines += popcount( lines & ( ( 1u << n ) - 1 ) );
+         return first + n;
+      }
+      newlines += popcount( lines );
+   }
+   return scan_sse2( first, last, set, negate, newlines );
+}
+
+/**
+ * first newline in [first, last), or last.
+ */
+__attribute__(( target( "avx2" ) ))
+inline char const* find_newline_avx2( char const* first, char const* last )
+{
+   __m256i const nl = _mm256_set1_epi8( '\n' );
+
+   for ( ; last - first >= 32; first += 32 )
+   {
+      unsigned int const hit = _mm256_movemask_epi8( _mm256_cmpeq_epi8( _mm256_loadu_si256( reinterpret_cast< __m256i const* >( first ) ), nl ) );
+
+      if ( hit )
+      {
+         return first + lowest_bit( hit );
+      }
+   }
+   return find_newline_sse2( first, last );
+}
+
+/**
+ * number of newlines in [first, last).
+ */
+__attribute__(( target( "avx2" ) ))
+inline const long count_newlines_avx2( char const* first, char const* last )
+{
+   __m256i const nl = _mm256_set1_epi8( '\n' );
+   long count = 0;
+
+   for ( ; last - first >= 32; first += 32 )
+   {
+      count += popcount( _mm256_movemask_epi8( _mm256_cmpeq_epi8( _mm256_loadu_si256( reinterpret_cast< __m256i const* >( first ) ), nl ) ) );
+   }
+   return count + count_newlines_sse2( first, last );
+}
+
+/// @}
+
+#endif // _WORDINDEX_HAVE_AVX2
+
+/**
+ * \name Dispatching kernels
+ * @{
+ */
+
+/**
+ * first position in [first, last) with a byte in set; add the number of
+ * newlines before that position to newlines.
+ */
+inline char const* find_in_set( char const* first, char const* last, ByteSet const& set, long& newlines )
+{
+#if defined( _WORDINDEX_HAVE_AVX2 )
+   if ( set.is_vectorizable() && have_avx2() ) return scan_avx2( first, last, set, false, newlines );
+#endif
+#if defined( _WORDINDEX_HAVE_SSE2 )
+   if ( set.is_vectorizable() ) return scan_sse2( first, last, set, false, newlines );
+#endif
+   return scan_scalar( first, last, set, false, newlines );
+}
+
+/**
+ * first position in [first, last) with a byte not in set.
+ */
+inline char const* find_not_in_set( char const* first, char const* last, ByteSet const& set )
+{
+   long newlines = 0;
+#if defined( _WORDINDEX_HAVE_AVX2 )
+   if ( set.is_vectorizable() && have_avx2() ) return scan_avx2( first, last, set, true, newlines );
+#endif
+#if defined( _WORDINDEX_HAVE_SSE2 )
+   if ( set.is_vectorizable() ) return scan_sse2( first, last, set, true, newlines );
+#endif
+   return scan_scalar( first, last, set, true, newlines );
+}
+
+/**
+ * first newline in [first, last), or last.
+ */
+inline char const* find_newline( char const* first, char const* last )
+{
+#if defined( _WORDINDEX_HAVE_AVX2 )
+   if ( have_avx2() ) return find_newline_avx2( first, last );
+#endif
+#if defined( _WORDINDEX_HAVE_SSE2 )
+   return find_newline_sse2( first, last );
+#else
+   for ( ; first != last && '\n' != *first; ++first )
+   {
+      ;
+   }
+   return first;
+#endif
+}
+
+/**
+ * number of newlines in [first, last).
+ */
+inline const long count_newlines( char const* first, char const* last )
+{
+#if defined( _WORDINDEX_HAVE_AVX2 )
+   if ( have_avx2() ) return count_newlines_avx2( first, last );
+#endif
+#if defined( _WORDINDEX_HAVE_SSE2 )
+   return count_newlines_sse2( first, last );
+#else
+   long count = 0;
+   for ( ; first != last; ++first )
+   {
+      count += ( '\n' == *first );
+   }
+   return count;
+#endif
+}
+
+/// @}
+
+} // namespace wordindex
+
+#endif // scankernel_h_included
+
+/*
+ * end of file
+ */
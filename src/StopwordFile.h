@@ -0,0 +1,233 @@
+/*
+ * StopwordFile.h - precompiled keyword (stopword) file.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef stopwordfile_h_included
+#define stopwordfile_h_included
+
+#include "Hash.h"          // for hash_type
+#include "MappedFile.h"    // for class MappedFile
+#include "StopwordTable.h" // for class StopwordTable
+#include "Utility.h"       // for class UnCopyable, to_charptr()
+
+#include <cstring>         // for std::memcmp()
+#include <fstream>         // for std::ifstream
+#include <ostream>         // for std::ostream
+#include <string>          // for std::string
+
+namespace wordindex {
+
+/**
+ * precompiled keyword file: a StopwordTable as it is laid out in memory, so
+ * that it can be used directly from a memory-mapped file:
+ *
+ *   header  magic "WIKW", format version, byte order mark, words, slots, buckets
+ *   hashes  slots words of 64 bits
+ *   offsets slots + 1 words of 32 bits
+ *   seeds   buckets words of 32 bits
+ *   chars   the characters of the words
+ *
+ * Numbers are stored in the byte order of the machine that wrote the file;
+ * a file written on a machine with another byte order is rejected.
+ */
+class StopwordFile : private UnCopyable
+{
+public:
+   /**
+    * the offset, count and seed type.
+    */
+   typedef StopwordTable::offset_type offset_type;
+
+   /**
+    * the format version.
+    */
+   enum { version = 1 };
+
+   /**
+    * constructor; map the given file, see is_open().
+    */
+   explicit StopwordFile( std::string const& filename )
+   : m_file( filename )
+   , m_table( 0, NULL, NULL, NULL, 0, NULL, 0 )
+   , m_open( false )
+   {
+      open();
+   }
+
+   /**
+    * true if the given file starts like a precompiled keyword file.
+    */
+   static const bool is_stopword_file( std::string const& filename )
+   {
+      std::ifstream is( to_charptr( filename ), std::ios::binary );
+
+      char header[ magic_size ] = { 0 };
+
+      return is.read( header, magic_size ) && 0 == std::memcmp( header, magic(), magic_size );
+   }
+
+   /**
+    * true if the file is a valid precompiled keyword file of this version and byte order.
+    */
+   const bool is_open() const
+   {
+      return m_open;
+   }
+
+   /**
+    * the keyword table; valid as long as this object exists.
+    */
+   StopwordTable const& table() const
+   {
+      return m_table;
+   }
+
+   /**
+    * write the given table as precompiled keyword file.
+    */
+   static void write( std::ostream& os, StopwordTable const& table )
+   {
+      Header header;
+
+      std::memcpy( header.magic, magic(), magic_size );
+      header.version    = version;
+      header.byte_order = byte_order_mark;
+      header.words      = table.size();
+      header.slots      = table.slots();
+      header.buckets    = table.buckets();
+
+      os.write( reinterpret_cast< char const* >( &header ), sizeof header );
+      os.write( reinterpret_cast< char const* >( table.hashes()  ), table.slots() * sizeof( hash_type ) );
+      os.write( reinterpret_cast< char const* >( table.offsets() ), ( table.slots() + 1 ) * sizeof( offset_type ) );
+      os.write( reinterpret_cast< char const* >( table.seeds()   ), table.buckets() * sizeof( offset_type ) );
+      os.write( table.chars(), table.offsets()[ table.slots() ] );
+   }
+
+private:
+   /**
+    * the value of Header::byte_order in the writer's byte order; the size of the magic.
+    */
+   enum { byte_order_mark = 0x01020304, magic_size = 4 };
+
+   /**
+    * the file header; its size keeps the hashes that follow 8-byte aligned.
+    */
+   struct Header
+   {
+      char        magic[ magic_size ]; ///< see magic()
+      offset_type version;     ///< format version
+      offset_type byte_order;  ///< byte_order_mark as written
+      offset_type words;       ///< number of keywords
+      offset_type slots;       ///< number of slots
+      offset_type buckets;     ///< number of buckets
+   };
+
+   /**
+    * the file magic.
+    */
+   static char const* magic()
+   {
+      return "WIKW";
+   }
+
+   /**
+    * validate the mapped file and set up the table.
+    */
+   void open()
+   {
+      if ( !m_file.is_open() || m_file.size() < sizeof( Header ) )
+      {
+         return;
+      }
+
+      Header const& header = *reinterpret_cast< Header const* >( m_file.begin() );
+
+      if ( 0 != std::memcmp( header.magic, magic(), magic_size )
+         || version != header.version || byte_order_mark != header.byte_order
+         || 0 == header.slots || 0 == header.buckets )
+      {
+         return;
+      }
+
+      MappedFile::size_type const fixed =
+         sizeof( Header )
+         + header.slots * sizeof( hash_type )
+         + ( header.slots + 1 ) * sizeof( offset_type )
+         + header.buckets * sizeof( offset_type );
+
+      if ( m_file.size() < fixed )
+      {
+         return;
+      }
+
+      char const* pos = m_file.begin() + sizeof( Header );
+
+      hash_type   const* const hashes  = reinterpret_cast< hash_type   const* >( pos ); pos += header.slots * sizeof( hash_type );
+      offset_type const* const offsets = reinterpret_cast< offset_type const* >( pos ); pos += ( header.slots + 1 ) * sizeof( offset_type );
+      offset_type const* const seeds   = reinterpret_cast< offset_type const* >( pos ); pos += header.buckets * sizeof( offset_type );
+
+      if ( m_file.size() != fixed + offsets[ header.slots ] )
+      {
+         return;
+      }
+
+      // words must lie within the characters:
+      for ( offset_type slot = 0; slot < header.slots; ++slot )
+      {
+         if ( offsets[ slot ] > offsets[ slot + 1 ] )
+         {
+            return;
+         }
+      }
+
+      m_table = StopwordTable( header.words, pos, offsets, hashes, header.slots, seeds, header.buckets );
+      m_open  = true;
+   }
+
+   /**
+    * the mapped file.
+    */
+   MappedFile m_file;
+
+   /**
+    * the keyword table in the mapped file.
+    */
+   StopwordTable m_table;
+
+   /**
+    * true if the file is valid.
+    */
+   bool m_open;
+};
+
+} // namespace wordindex
+
+#endif // stopwordfile_h_included
+
+/*
+ * end of file
+ */
@@ -0,0 +1,520 @@
+/*
+ * StopwordTable.h - perfect-hash keyword (stopword) table and its generator.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef stopwordtable_h_included
+#define stopwordtable_h_included
+
+#include "Config.h"     // for _WORDINDEX_HAVE_CONSTEXPR14
+#include "Dictionary.h" // for class Dictionary
+#include "Hash.h"       // for hash_type, hash_add()
+#include "TokenView.h"  // for class TokenView
+#include "Utility.h"    // for class UnCopyable
+
+#include <algorithm>    // for std::sort(), std::find()
+#include <cstring>      // for std::memcmp()
+#include <ostream>      // for std::ostream
+#include <string>       // for std::string
+#include <utility>      // for std::pair<>
+#include <vector>       // for std::vector<>
+
+namespace wordindex {
+
+/**
+ * read-only set of keywords in a perfect-hash table (hash and displace): the
+ * token hash selects a bucket, the bucket's seed selects the one slot its word
+ * can be in. A lookup costs the token hash, which the tokenizer provides, and
+ * at most one compare. The table does not own its arrays, so that it can be
+ * defined constexpr in a generated header, see StopwordTableBuilder.
+ */
+class StopwordTable
+{
+public:
+   /**
+    * the offset, count and seed type.
+    */
+   typedef unsigned int offset_type;
+
+   /**
+    * constructor; the arrays hold per slot the offset of its word in chars
+    * (followed by the total size) and its hash (0 for an empty slot), and
+    * per bucket the seed.
+    */
+   constexpr StopwordTable
+   ( offset_type const words
+   , char const* const chars, offset_type const* const offsets, hash_type const* const hashes, offset_type const slots
+   , offset_type const* const seeds, offset_type const buckets )
+   : m_words  ( words   )
+   , m_chars  ( chars   )
+   , m_offsets( offsets )
+   , m_hashes ( hashes  )
+   , m_slots  ( slots   )
+   , m_seeds  ( seeds   )
+   , m_buckets( buckets )
+   {
+   }
+
+   /**
+    * number of keywords.
+    */
+   constexpr offset_type size() const
+   {
+      return m_words;
+   }
+
+   /**
+    * the bucket of the given hash.
+    */
+   static constexpr offset_type bucket_of( hash_type const hash, offset_type const buckets )
+   {
+      return static_cast< offset_type >( ( hash >> 32 ) % buckets );
+   }
+
+   /**
+    * the slot of the given hash with the given seed.
+    */
+   static constexpr offset_type slot_of( hash_type const hash, offset_type const seed, offset_type const slots )
+   {
+      return static_cast< offset_type >( mix( hash ^ ( seed * 0x9E3779B97F4A7C15ULL ) ) % slots );
+   }
+
+   /**
+    * true if the given token with the given hash is a keyword.
+    */
+   const bool contains( TokenView const& word, hash_type const hash ) const
+   {
+      offset_type const slot = slot_of( hash, m_seeds[ bucket_of( hash, m_buckets ) ], m_slots );
+
+      return m_hashes[ slot ] == hash
+         && m_offsets[ slot + 1 ] - m_offsets[ slot ] == word.size()
+         && 0 == std::memcmp( m_chars + m_offsets[ slot ], word.begin(), word.size() );
+   }
+
+   /**
+    * number of words of this table that other contains as well.
+    */
+   const offset_type shared( StopwordTable const& other ) const
+   {
+      offset_type count = 0;
+
+      for ( offset_type slot = 0; slot < m_slots; ++slot )
+      {
+         if ( m_offsets[ slot ] != m_offsets[ slot + 1 ]
+            && other.contains( TokenView( m_chars + m_offsets[ slot ], m_chars + m_offsets[ slot + 1 ] ), m_hashes[ slot ] ) )
+         {
+            ++count;
+         }
+      }
+      return count;
+   }
+
+   /**
+    * 1 if the given word is a keyword, 0 otherwise.
+    */
+   const std::size_t count( std::string const& word ) const
+   {
+      return contains( TokenView( word.data(), word.data() + word.size() ), hash_bytes( word.data(), word.data() + word.size() ) ) ? 1 : 0;
+   }
+
+   /**
+    * number of slots.
+    */
+   constexpr offset_type slots() const
+   {
+      return m_slots;
+   }
+
+   /**
+    * number of buckets.
+    */
+   constexpr offset_type buckets() const
+   {
+      return m_buckets;
+   }
+
+   /**
+    * the characters of the words, by slot.
+    */
+   constexpr char const* chars() const
+   {
+      return m_chars;
+   }
+
+   /**
+    * offset of each slot's word in chars(), followed by the total (slots() + 1 values).
+    */
+   constexpr offset_type const* offsets() const
+   {
+      return m_offsets;
+   }
+
+   /**
+    * hash of each slot's word; 0 for an empty slot.
+    */
+   constexpr hash_type const* hashes() const
+   {
+      return m_hashes;
+   }
+
+   /**
+    * the seed of each bucket.
+    */
+   constexpr offset_type const* seeds() const
+   {
+      return m_seeds;
+   }
+
+#ifdef _WORDINDEX_HAVE_CONSTEXPR14
+   /**
+    * true if every word is in the slot its hash selects (compile-time check).
+    */
+   constexpr bool verify() const
+   {
+      offset_type words = 0;
+
+      for ( offset_type slot = 0; slot < m_slots; ++slot )
+      {
+         if ( m_offsets[ slot ] == m_offsets[ slot + 1 ] )
+         {
+            continue;
+         }
+
+         hash_type hash = hash_basis;
+
+         for ( offset_type i = m_offsets[ slot ]; i < m_offsets[ slot + 1 ]; ++i )
+         {
+            hash = hash_add( hash, m_chars[ i ] );
+         }
+
+         if ( hash != m_hashes[ slot ] || slot != slot_of( hash, m_seeds[ bucket_of( hash, m_buckets ) ], m_slots ) )
+         {
+            return false;
+         }
+         ++words;
+      }
+      return words == m_words;
+   }
+#endif
+
+private:
+   /**
+    * scramble the bits of x (splitmix64 finalizer).
+    */
+   static constexpr hash_type mix( hash_type const x )
+   {
+      return mix_step( mix_step( mix_step( x, 30 ) * 0xBF58476D1CE4E5B9ULL, 27 ) * 0x94D049BB133111EBULL, 31 );
+   }
+
+   /**
+    * x xor x shifted right by the given number of bits.
+    */
+   static constexpr hash_type mix_step( hash_type const x, int const shift )
+   {
+      return x ^ ( x >> shift );
+   }
+
+   offset_type        m_words;    ///< number of keywords
+   char const*        m_chars;    ///< the characters of the words, by slot
+   offset_type const* m_offsets;  ///< offset of each slot's word in m_chars, followed by the total
+   hash_type const*   m_hashes;   ///< hash of each slot's word; 0 for an empty slot
+   offset_type        m_slots;    ///< number of slots
+   offset_type const* m_seeds;    ///< the seed of each bucket
+   offset_type        m_buckets;  ///< number of buckets
+};
+
+/**
+ * collect keywords and build their perfect-hash table; write it as a C++
+ * header that defines a constexpr StopwordTable.
+ */
+class StopwordTableBuilder : private UnCopyable
+{
+public:
+   /**
+    * the offset, count and seed type.
+    */
+   typedef StopwordTable::offset_type offset_type;
+
+   /**
+    * add a keyword.
+    */
+   void insert( std::string const& word )
+   {
+      m_words.intern( word );
+   }
+
+   /**
+    * number of keywords.
+    */
+   const offset_type size() const
+   {
+      return m_words.size();
+   }
+
+   /**
+    * build the table; false if no seed separates some bucket's words.
+    */
+   const bool build()
+   {
+      offset_type const words   = size();
+      offset_type const slots   = words + words / 4 + 1;   // load factor 0.8
+      offset_type const buckets = words / 4 + 1;           // about four words per bucket
+
+      /*
+       * distribute the words over the buckets; place the largest buckets first:
+       */
+      std::vector< std::vector< offset_type > > members( buckets );
+
+      for ( offset_type id = 0; id < words; ++id )
+      {
+         members[ StopwordTable::bucket_of( m_words.hash( id ), buckets ) ].push_back( id );
+      }
+
+      std::vector< std::pair< offset_type, offset_type > > order;
+
+      for ( offset_type b = 0; b < buckets; ++b )
+      {
+         order.push_back( std::make_pair( static_cast< offset_type >( members[ b ].size() ), b ) );
+      }
+      std::sort( order.rbegin(), order.rend() );
+
+      /*
+       * find for each bucket the first seed that puts its words in free, distinct slots:
+       */
+      std::vector< offset_type > slot_of_id( words );
+      std::vector< bool > used( slots, false );
+
+      m_seeds.assign( buckets, 0 );
+
+      for ( offset_type i = 0; i < buckets && order[ i ].first > 0; ++i )
+      {
+         std::vector< offset_type > const& bucket = members[ order[ i ].second ];
+
+         offset_type seed = 0;
+
+         for ( ; seed < max_seed; ++seed )
+         {
+            std::vector< offset_type > taken;
+
+            for ( std::size_t k = 0; k < bucket.size(); ++k )
+            {
+               offset_type const slot = StopwordTable::slot_of( m_words.hash( bucket[ k ] ), seed, slots );
+
+               if ( used[ slot ] || taken.end() != std::find( taken.begin(), taken.end(), slot ) )
+               {
+                  break;
+               }
+               taken.push_back( slot );
+            }
+
+            if ( taken.size() == bucket.size() )
+            {
+               for ( std::size_t k = 0; k < bucket.size(); ++k )
+               {
+                  used[ taken[ k ] ] = true;
+                  slot_of_id[ bucket[ k ] ] = taken[ k ];
+               }
+               break;
+            }
+         }
+
+         if ( seed == max_seed )
+         {
+            return false;
+         }
+         m_seeds[ order[ i ].second ] = seed;
+      }
+
+      /*
+       * lay out the words by slot:
+       */
+      std::vector< offset_type > id_of_slot( slots, static_cast< offset_type >( Dictionary::npos ) );
+
+      for ( offset_type id = 0; id < words; ++id )
+      {
+         id_of_slot[ slot_of_id[ id ] ] = id;
+      }
+
+      m_chars.clear();
+      m_offsets.assign( 1, 0 );
+      m_hashes.assign( slots, 0 );
+
+      for ( offset_type slot = 0; slot < slots; ++slot )
+      {
+         if ( Dictionary::npos != id_of_slot[ slot ] )
+         {
+            TokenView const word = m_words.word( id_of_slot[ slot ] );
+
+            m_chars.insert( m_chars.end(), word.begin(), word.end() );
+            m_hashes[ slot ] = m_words.hash( id_of_slot[ slot ] );
+         }
+         m_offsets.push_back( static_cast< offset_type >( m_chars.size() ) );
+      }
+
+      return true;
+   }
+
+   /**
+    * the built table; valid as long as this builder is not changed.
+    */
+   const StopwordTable table() const
+   {
+      return StopwordTable
+      ( size()
+      , m_chars.data(), &m_offsets[ 0 ], &m_hashes[ 0 ], static_cast< offset_type >( m_hashes.size() )
+      , &m_seeds[ 0 ], static_cast< offset_type >( m_seeds.size() ) );
+   }
+
+   /**
+    * write the built table as a C++ header that defines the constexpr
+    * StopwordTable builtin_stopwords; origin describes where the words came from.
+    */
+   void write_header( std::ostream& os, std::string const& origin ) const
+   {
+      os <<
+         "/*\n"
+         " * Stopwords.h - compiled-in keywords (stopwords), see option --builtin-keywords.\n"
+         " *\n"
+         " * This file is generated from " << origin << ", do not edit.\n"
+         " * Regenerate with: wordindex --keywords=" << origin << " --make-keywords=src/Stopwords.h\n"
+         " */\n"
+         "\n"
+         "#ifndef stopwords_h_included\n"
+         "#define stopwords_h_included\n"
+         "\n"
+         "#include \"StopwordTable.h\"\n"
+         "\n"
+         "namespace wordindex {\n"
+         "\n"
+         "namespace builtin {\n"
+         "\n";
+
+      os << "constexpr char chars[] =\n{";
+      for ( std::size_t i = 0; i < m_chars.size(); ++i )
+      {
+         os << ( i % 16 ? " " : "\n   " ) << char_literal( m_chars[ i ] ) << ",";
+      }
+      os << "\n   '\\0'\n};\n\n";
+
+      write_array( os, "StopwordTable::offset_type", "offsets", m_offsets, "u"   );
+      write_array( os, "hash_type"                 , "hashes" , m_hashes , "ULL" );
+      write_array( os, "StopwordTable::offset_type", "seeds"  , m_seeds  , "u"   );
+
+      os <<
+         "} // namespace builtin\n"
+         "\n"
+         "/**\n"
+         " * the compiled-in keywords.\n"
+         " */\n"
+         "constexpr StopwordTable builtin_stopwords\n"
+         "( " << size() << "\n"
+         ", builtin::chars, builtin::offsets, builtin::hashes, " << m_hashes.size() << "\n"
+         ", builtin::seeds, " << m_seeds.size() << " );\n"
+         "\n"
+         "#ifdef _WORDINDEX_HAVE_CONSTEXPR14\n"
+         "static_assert( builtin_stopwords.verify(), \"Stopwords.h: inconsistent table, regenerate it\" );\n"
+         "#endif\n"
+         "\n"
+         "} // namespace wordindex\n"
+         "\n"
+         "#endif // stopwords_h_included\n"
+         "\n"
+         "/*\n"
+         " * end of file\n"
+         " */\n";
+   }
+
+private:
+   /**
+    * number of seeds to try per bucket before giving up.
+    */
+   enum { max_seed = 1 << 20 };
+
+   /**
+    * the given character as C++ character literal.
+    */
+   static const std::string char_literal( char const chr )
+   {
+      unsigned char const c = static_cast< unsigned char >( chr );
+
+      if ( c >= ' ' && c < 127 && '\'' != c && '\\' != c )
+      {
+         return std::string( "'" ) + chr + "'";
+      }
+
+      char const digits[] = { '\'', '\\', char( '0' + ( c >> 6 ) ), char( '0' + ( ( c >> 3 ) & 7 ) ), char( '0' + ( c & 7 ) ), '\'' };
+
+      return std::string( digits, digits + sizeof digits );
+   }
+
+   /**
+    * write a constexpr array definition.
+    */
+   template < typename T >
+   static void write_array( std::ostream& os, char const* type, char const* name, std::vector< T > const& values, char const* suffix )
+   {
+      os << "constexpr " << type << " " << name << "[] =\n{";
+
+      for ( std::size_t i = 0; i < values.size(); ++i )
+      {
+         os << ( i % 8 ? " " : "\n   " ) << values[ i ] << suffix << ( i + 1 < values.size() ? "," : "" );
+      }
+      os << "\n};\n\n";
+   }
+
+   /**
+    * the keywords.
+    */
+   Dictionary m_words;
+
+   /**
+    * the characters of the words, by slot.
+    */
+   std::vector< char > m_chars;
+
+   /**
+    * offset of each slot's word, followed by the total.
+    */
+   std::vector< offset_type > m_offsets;
+
+   /**
+    * hash of each slot's word; 0 for an empty slot.
+    */
+   std::vector< hash_type > m_hashes;
+
+   /**
+    * the seed of each bucket.
+    */
+   std::vector< offset_type > m_seeds;
+};
+
+} // namespace wordindex
+
+#endif // stopwordtable_h_included
+
+/*
+ * end of file
+ */
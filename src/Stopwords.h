@@ -0,0 +1,130 @@
+/*
+ * Stopwords.h - compiled-in keywords (stopwords), see option --builtin-keywords.
+ *
+ * This file is generated from src/Stopwords.txt, do not edit.
+ * Regenerate with: wordindex --keywords=src/Stopwords.txt --make-keywords=src/Stopwords.h
+ */
+
+#ifndef stopwords_h_included
+#define stopwords_h_included
+
+#include "StopwordTable.h"
+
+namespace wordindex {
+
+namespace builtin {
+
+constexpr char chars[] =
+{
+   'e', 'a', 'c', 'h', 'a', 't', 'i', 'w', 'h', 'y', 's', 'h', 'e', 't', 'h', 'r',
+   'o', 'u', 'g', 'h', 'a', 'm', 'w', 'h', 'a', 't', 't', 'h', 'i', 's', 'm', 'y',
+   'h', 'e', 'r', 'e', 'w', 'h', 'i', 'c', 'h', 't', 'h', 'e', 'm', 'b', 'e', 'i',
+   'n', 'g', 't', 'h', 'e', 'i', 'r', 'd', 'o', 'e', 's', 'a', 'b', 'o', 'v', 'e',
+   'c', 'o', 'u', 'l', 'd', 'w', 'o', 'u', 'l', 'd', 'a', 'l', 'l', 'h', 'a', 'v',
+   'i', 'n', 'g', 'o', 't', 'h', 'e', 'r', 'o', 'u', 't', 'w', 'h', 'o', 'm', 't',
+   'o', 'w', 'a', 's', 'i', 'n', 't', 'o', 'h', 'a', 's', 't', 'h', 'e', 't', 'h',
+   'a', 'n', 'y', 'o', 'u', 'r', 's', 'e', 'l', 'v', 'e', 's', 'i', 'f', 'a', 'm',
+   'o', 's', 't', 'a', 'n', 'y', 'b', 'e', 'c', 'a', 'u', 's', 'e', 'b', 'y', 'n',
+   'o', 't', 'w', 'h', 'i', 'l', 'e', 'a', 'g', 'a', 'i', 'n', 's', 't', 'm', 'e',
+   'a', 's', 'h', 'o', 'w', 'i', 't', 'd', 'u', 'r', 'i', 'n', 'g', 'j', 'u', 's',
+   't', 'u', 'p', 'o', 'r', 'o', 'w', 'n', 'y', 'o', 'u', 'r', 's', 'e', 'l', 'f',
+   'o', 'u', 'r', 's', 'v', 'e', 'r', 'y', 'a', 'n', 't', 'h', 'e', 'y', 't', 'h',
+   'e', 'r', 'e', 'w', 'i', 'l', 'l', 'f', 'u', 'r', 't', 'h', 'e', 'r', 'n', 'o',
+   'r', 'h', 'e', 'r', 's', 'e', 'l', 'f', 'w', 'i', 't', 'h', 'w', 'h', 'e', 'n',
+   'h', 'i', 'm', 's', 'e', 'l', 'f', 'o', 'u', 'r', 's', 'e', 'l', 'v', 'e', 's',
+   'h', 'e', 'f', 'e', 'w', 'd', 'i', 'd', 'h', 'a', 'v', 'e', 'b', 'e', 't', 'w',
+   'e', 'e', 'n', 'a', 'g', 'a', 'i', 'n', 'h', 'e', 'r', 'b', 'u', 't', 's', 'u',
+   'c', 'h', 'w', 'h', 'e', 'r', 'e', 'd', 'o', 'f', 'o', 'r', 'b', 'e', 'h', 'i',
+   'm', 's', 'o', 'd', 'o', 'w', 'n', 't', 'h', 'o', 's', 'e', 'a', 'r', 'e', 's',
+   'a', 'm', 'e', 't', 'h', 'a', 't', 'b', 'o', 't', 'h', 'i', 'n', 'o', 'n', 'c',
+   'e', 'b', 'e', 'e', 'n', 'o', 'f', 'n', 'o', 'w', 's', 'o', 'm', 'e', 'o', 'f',
+   'f', 'f', 'r', 'o', 'm', 'w', 'e', 'r', 'e', 's', 'h', 'o', 'u', 'l', 'd', 'm',
+   'y', 's', 'e', 'l', 'f', 'b', 'e', 'l', 'o', 'w', 'a', 'f', 't', 'e', 'r', 'c',
+   'a', 'n', 'h', 'e', 'r', 's', 'h', 'a', 'd', 'i', 't', 's', 'e', 'l', 'f', 'w',
+   'h', 'o', 'a', 'n', 'd', 'i', 't', 's', 'i', 's', 'y', 'o', 'u', 'a', 'b', 'o',
+   'u', 't', 'h', 'i', 's', 'o', 'n', 'l', 'y', 'u', 'n', 't', 'i', 'l', 'o', 'u',
+   'r', 'n', 'o', 'y', 'o', 'u', 'r', 'b', 'e', 'f', 'o', 'r', 'e', 'u', 'n', 'd',
+   'e', 'r', 't', 'h', 'e', 's', 'e', 'o', 'n', 'y', 'o', 'u', 'r', 's', 't', 'h',
+   'e', 'n', 'w', 'e', 't', 'h', 'e', 'm', 's', 'e', 'l', 'v', 'e', 's', 't', 'h',
+   'e', 'i', 'r', 's', 'm', 'o', 'r', 'e', 'o', 'v', 'e', 'r', 'd', 'o', 'i', 'n',
+   'g', 't', 'o', 'o',
+   '\0'
+};
+
+constexpr StopwordTable::offset_type offsets[] =
+{
+   0u, 4u, 6u, 7u, 10u, 13u, 20u, 20u,
+   22u, 26u, 30u, 32u, 32u, 36u, 41u, 45u,
+   45u, 50u, 55u, 59u, 64u, 69u, 69u, 74u,
+   77u, 83u, 83u, 88u, 91u, 95u, 97u, 100u,
+   100u, 104u, 107u, 107u, 107u, 110u, 114u, 124u,
+   126u, 127u, 131u, 134u, 134u, 141u, 143u, 146u,
+   151u, 158u, 158u, 160u, 162u, 165u, 167u, 167u,
+   173u, 177u, 177u, 179u, 181u, 184u, 192u, 196u,
+   196u, 200u, 202u, 206u, 211u, 215u, 215u, 215u,
+   222u, 225u, 225u, 232u, 236u, 240u, 247u, 256u,
+   258u, 261u, 261u, 264u, 264u, 268u, 275u, 280u,
+   283u, 286u, 290u, 295u, 297u, 300u, 302u, 305u,
+   307u, 311u, 316u, 319u, 323u, 327u, 327u, 331u,
+   333u, 337u, 341u, 343u, 346u, 350u, 350u, 353u,
+   357u, 357u, 361u, 367u, 373u, 378u, 383u, 383u,
+   383u, 386u, 386u, 386u, 390u, 390u, 393u, 399u,
+   399u, 402u, 405u, 408u, 410u, 413u, 413u, 418u,
+   421u, 425u, 430u, 430u, 433u, 433u, 433u, 435u,
+   439u, 445u, 445u, 450u, 455u, 457u, 462u, 466u,
+   468u, 478u, 484u, 488u, 492u, 497u, 500u
+};
+
+constexpr hash_type hashes[] =
+{
+   2399200755332251048ULL, 620456643683264872ULL, 12638195996648667684ULL, 6829121804289788537ULL, 9387096024233451041ULL, 8789493305340027482ULL, 0ULL, 620431354915816019ULL,
+   11234446932156269327ULL, 2704337836786137153ULL, 624103723753283859ULL, 0ULL, 742532965847947307ULL, 14886822876704379938ULL, 2700408182227667939ULL, 0ULL,
+   12431351548139161864ULL, 16935418553531043207ULL, 15867295736529184464ULL, 4571440789225184042ULL, 12820858145739877566ULL, 0ULL, 8838576358550648930ULL, 16640971154896050852ULL,
+   11270473570612684252ULL, 0ULL, 730899674924722773ULL, 1871134702438174719ULL, 11228811935062823302ULL, 632818452916781220ULL, 6822364205824128306ULL, 0ULL,
+   17701056135916708259ULL, 3699728092784203075ULL, 0ULL, 0ULL, 6266135566914540924ULL, 2696750107041366842ULL, 13027050242084224344ULL, 628023482707099174ULL,
+   12638187200555641996ULL, 943779698914011890ULL, 16642968967524131789ULL, 0ULL, 9503134909063496123ULL, 623268094916032724ULL, 2403468754648211274ULL, 14882043299657492846ULL,
+   4535333379147303424ULL, 0ULL, 624134510078873767ULL, 620464340264662349ULL, 3701720407854142957ULL, 628038875869894128ULL, 0ULL, 9994905844814347912ULL,
+   16930542681612195231ULL, 0ULL, 631693652521310592ULL, 626092740288339108ULL, 1869439255507851807ULL, 2241511620741030668ULL, 15818348008331620766ULL, 0ULL,
+   7439618934287329281ULL, 620432454427444230ULL, 2700394988088129407ULL, 16928642263367703389ULL, 11968609537824046989ULL, 0ULL, 0ULL, 14923507080476793257ULL,
+   2403462157578442008ULL, 0ULL, 13381326984196347246ULL, 11991686087872398057ULL, 11238380984761251385ULL, 16736635484504225319ULL, 4030470807693013603ULL, 628906390544363382ULL,
+   15908540280042327065ULL, 0ULL, 14602970277440536766ULL, 0ULL, 3334851531003596507ULL, 1438188964080769615ULL, 12644979747856758223ULL, 3695795139690849228ULL,
+   27336165788644044ULL, 13172300041790241374ULL, 4007477477770853496ULL, 617372513566700692ULL, 15902905282948881040ULL, 623237308590442816ULL, 3707360902505730037ULL, 637603527521809367ULL,
+   15853816823481594965ULL, 4720678899086369066ULL, 16669731080549489229ULL, 683243228863131483ULL, 2696721519739033356ULL, 0ULL, 14778551851152030882ULL, 628032278800124862ULL,
+   508571082221258180ULL, 8499515821999699907ULL, 626105934427877640ULL, 2403467655136583063ULL, 6932689201082914001ULL, 0ULL, 1883801076392705514ULL, 9188557619686916277ULL,
+   0ULL, 4446163296446906764ULL, 11958705164271055210ULL, 11964592317811630749ULL, 14255127978042943954ULL, 13799593374022494953ULL, 0ULL, 0ULL,
+   17717988973921729989ULL, 0ULL, 0ULL, 742557155103767949ULL, 0ULL, 3699715998156292754ULL, 15935806408102493802ULL, 0ULL,
+   6829141595499096335ULL, 16642937081686913670ULL, 3149117958293638553ULL, 628046572451291605ULL, 13069864042462355804ULL, 0ULL, 4572301706829884030ULL, 3707345509342935083ULL,
+   517310000640576183ULL, 2291359479729204271ULL, 0ULL, 1871132503414918297ULL, 0ULL, 0ULL, 626942662776756986ULL, 15224151675360764202ULL,
+   15607963802542256830ULL, 0ULL, 12228426714503868781ULL, 16929517474623570120ULL, 626097138334851952ULL, 10204291617770170939ULL, 2700409281739296150ULL, 633691465149391529ULL,
+   12764932022478934113ULL, 2552829971265271196ULL, 944603233123352704ULL, 14025209469941882991ULL, 8498452662884257092ULL, 6267237277565819121ULL
+};
+
+constexpr StopwordTable::offset_type seeds[] =
+{
+   6u, 16u, 21u, 0u, 0u, 4u, 0u, 766u,
+   27u, 22u, 4u, 5u, 32u, 15u, 1u, 36u,
+   0u, 5u, 60u, 0u, 50u, 35u, 71u, 1u,
+   25u, 10u, 0u, 7u, 4u, 0u, 20u, 4u
+};
+
+} // namespace builtin
+
+/**
+ * the compiled-in keywords.
+ */
+constexpr StopwordTable builtin_stopwords
+( 126
+, builtin::chars, builtin::offsets, builtin::hashes, 158
+, builtin::seeds, 32 );
+
+#ifdef _WORDINDEX_HAVE_CONSTEXPR14
+static_assert( builtin_stopwords.verify(), "Stopwords.h: inconsistent table, regenerate it" );
+#endif
+
+} // namespace wordindex
+
+#endif // stopwords_h_included
+
+/*
+ * end of file
+ */
@@ -0,0 +1,248 @@
+/*
+ * TokenView.h - non-owning view of a token.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef tokenview_h_included
+#define tokenview_h_included
+
+#include <algorithm>   // for std::equal(), std::min()
+#include <cstddef>     // for std::size_t
+#include <ostream>     // for std::basic_ostream<>
+#include <string>      // for std::basic_string<>, std::char_traits<>
+
+namespace wordindex {
+
+/**
+ * non-owning view of a token in a character range.
+ */
+template < typename C >
+class basic_token_view
+{
+public:
+   /**
+    * the character type.
+    */
+   typedef C char_type;
+
+   /**
+    * the size type.
+    */
+   typedef std::size_t size_type;
+
+   /**
+    * the const iterator type.
+    */
+   typedef char_type const* const_iterator;
+
+   /**
+    * default constructor; empty view.
+    */
+   basic_token_view()
+   : m_first( NULL )
+   , m_last ( NULL )
+   {
+      ;
+   }
+
+   /**
+    * constructor.
+    */
+   basic_token_view( const_iterator first, const_iterator last )
+   : m_first( first )
+   , m_last ( last  )
+   {
+      ;
+   }
+
+   /**
+    * begin of token.
+    */
+   const_iterator begin() const
+   {
+      return m_first;
+   }
+
+   /**
+    * end of token.
+    */
+   const_iterator end() const
+   {
+      return m_last;
+   }
+
+   /**
+    * number of characters in token.
+    */
+   const size_type size() const
+   {
+      return m_last - m_first;
+   }
+
+   /**
+    * true if token is empty.
+    */
+   const bool empty() const
+   {
+      return m_first == m_last;
+   }
+
+   /**
+    * the token as string (copy).
+    */
+   const std::basic_string< char_type > str() const
+   {
+      return std::basic_string< char_type >( m_first, m_last );
+   }
+
+private:
+   /**
+    * begin of token.
+    */
+   const_iterator m_first;
+
+   /**
+    * end of token.
+    */
+   const_iterator m_last;
+};
+
+/**
+ * write count fill characters to stream.
+ */
+template < typename C, typename T >
+void pad( std::basic_ostream< C, T >& os, std::streamsize count )
+{
+   for ( C const chr = os.fill(); count > 0; --count )
+   {
+      os.put( chr );
+   }
+}
+
+/**
+ * write token view to stream, honouring the field width.
+ */
+template < typename C, typename T >
+std::basic_ostream< C, T >& operator<<( std::basic_ostream< C, T >& os, basic_token_view< C > const& token )
+{
+   std::streamsize const fill = os.width() > static_cast< std::streamsize >( token.size() ) ? os.width() - token.size() : 0;
+   bool const left = std::ios_base::left == ( os.flags() & std::ios_base::adjustfield );
+
+   os.width( 0 );
+
+   if ( !left ) pad( os, fill );
+   os.write( token.begin(), token.size() );
+   if (  left ) pad( os, fill );
+
+   return os;
+}
+
+/**
+ * true if the token views have equal characters.
+ */
+template < typename C >
+const bool operator==( basic_token_view< C > const& lhs, basic_token_view< C > const& rhs )
+{
+   return lhs.size() == rhs.size() && std::equal( lhs.begin(), lhs.end(), rhs.begin() );
+}
+
+/**
+ * true if the token view and string have equal characters.
+ */
+template < typename C >
+const bool operator==( basic_token_view< C > const& lhs, std::basic_string< C > const& rhs )
+{
+   return lhs.size() == rhs.size() && std::equal( lhs.begin(), lhs.end(), rhs.begin() );
+}
+
+/**
+ * true if the string and token view have equal characters.
+ */
+template < typename C >
+const bool operator==( std::basic_string< C > const& lhs, basic_token_view< C > const& rhs )
+{
+   return rhs == lhs;
+}
+
+/**
+ * true if the token view and C-string have equal characters.
+ */
+template < typename C >
+const bool operator==( basic_token_view< C > const& lhs, C const* rhs )
+{
+   return lhs == std::basic_string< C >( rhs );
+}
+
+/**
+ * true if the C-string and token view have equal characters.
+ */
+template < typename C >
+const bool operator==( C const* lhs, basic_token_view< C > const& rhs )
+{
+   return rhs == lhs;
+}
+
+/**
+ * true if the token views have different characters.
+ */
+template < typename C >
+const bool operator!=( basic_token_view< C > const& lhs, basic_token_view< C > const& rhs )
+{
+   return !( lhs == rhs );
+}
+
+/**
+ * true if lhs orders before rhs; characters compare as unsigned, like std::string.
+ */
+template < typename C >
+const bool operator<( basic_token_view< C > const& lhs, basic_token_view< C > const& rhs )
+{
+   std::size_t const n = std::min( lhs.size(), rhs.size() );
+
+   for ( std::size_t i = 0; i < n; ++i )
+   {
+      typedef std::char_traits< C > traits;
+
+      if ( !traits::eq( lhs.begin()[ i ], rhs.begin()[ i ] ) )
+      {
+         return traits::lt( lhs.begin()[ i ], rhs.begin()[ i ] );
+      }
+   }
+   return lhs.size() < rhs.size();
+}
+
+/**
+ * token view for char character type.
+ */
+typedef basic_token_view< char > TokenView;
+
+} // namespace wordindex
+
+#endif // tokenview_h_included
+
+/*
+ * end of file
+ */
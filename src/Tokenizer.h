@@ -26,14 +26,116 @@
  * \file
  */
 
-#include "Pair.h"     // for pair_type
-#include "Utility.h"  // for class UnCopyable
+#ifndef tokenizer_h_included
+#define tokenizer_h_included
+
+#include "Hash.h"       // for hash_bytes()
+#include "Pair.h"       // for pair_type
+#include "ScanKernel.h" // for find_in_set() etc.
+#include "TokenView.h"  // for class basic_token_view<>
+#include "Utility.h"    // for class UnCopyable
 
 #include <algorithm>   // for std::transform()
 #include <cassert>     // for ::assert()
+#include <cctype>      // for ::isalpha(), ::isdigit()
+#include <cstddef>     // for std::ptrdiff_t
+#include <iterator>    // for std::iterator<>, std::input_iterator_tag
+#include <ostream>     // for std::basic_ostream<>
+#include <string>      // for std::basic_string<>
+#include <vector>      // for std::vector<>
 
 namespace wordindex {
 
+/**
+ * character classification table for the tokenizers; one lookup per character.
+ */
+class CharClasses
+{
+public:
+   /**
+    * the character classes (bit flags).
+    */
+   enum class_type
+   {
+      none    = 0,      ///< no class
+      start   = 1 << 0, ///< valid first character of a token
+      follow  = 1 << 1, ///< valid second and following character of a token
+      comment = 1 << 2, ///< line comment start character
+      newline = 1 << 3, ///< line end character
+
+      token   = start | follow  ///< valid character within a token
+   };
+
+   /**
+    * constructor; default classes: start [_A-Za-z], follow [_A-Za-z0-9], comment [;#].
+    */
+   CharClasses()
+   {
+      for ( int chr = 0; chr < table_size; ++chr )
+      {
+         m_table[ chr ] = none;
+
+         if ( '_' == chr || ( chr < 128 && ::isalpha( chr ) ) )
+         {
+            m_table[ chr ] |= start | follow;
+         }
+         else if ( chr < 128 && ::isdigit( chr ) )
+         {
+            m_table[ chr ] |= follow;
+         }
+      }
+
+      add( ";#", comment );
+      add( "\n", newline );
+   }
+
+   /**
+    * add the given class to the given set of characters.
+    */
+   void add( std::string const& set, const int cls )
+   {
+      for ( std::string::const_iterator pos = set.begin(); pos != set.end(); ++pos )
+      {
+         m_table[ static_cast< unsigned char >( *pos ) ] |= cls;
+      }
+   }
+
+   /**
+    * true if character is a member of any of the given classes.
+    */
+   const bool is( const char chr, const int cls ) const
+   {
+      return 0 != ( m_table[ static_cast< unsigned char >( chr ) ] & cls );
+   }
+
+   /**
+    * the set of characters that are a member of any of the given classes.
+    */
+   const ByteSet byte_set( const int cls ) const
+   {
+      return ByteSet( m_table, cls );
+   }
+
+   /**
+    * the classes of the given character.
+    */
+   const int classes( const char chr ) const
+   {
+      return m_table[ static_cast< unsigned char >( chr ) ];
+   }
+
+private:
+   /**
+    * the number of table entries.
+    */
+   enum { table_size = 256 };
+
+   /**
+    * the character class table.
+    */
+   unsigned char m_table[ table_size ];
+};
+
 /**
  * separate stream input into token, line number pairs.
  */
@@ -98,7 +200,7 @@ public:
        */
       const bool is_start_comment( char_type chr )
       {
-          return ';' == chr || '#' == chr;
+          return m_tokenizer->m_classes.is( chr, CharClasses::comment );
       }
 
       /**
@@ -106,7 +208,7 @@ public:
        */
       const bool is_start( char_type chr )
       {
-          return '_' == chr || ::isalpha( chr );
+          return m_tokenizer->m_classes.is( chr, CharClasses::start );
       }
 
       /**
@@ -114,9 +216,7 @@ public:
        */
       const bool is_follow( char_type chr )
       {
-          return '_' == chr
-              || ::isalnum( chr )
-              || std::string::npos != m_tokenizer->m_follow.find_first_of( chr );
+          return m_tokenizer->m_classes.is( chr, CharClasses::follow );
       }
 
       /**
@@ -124,7 +224,7 @@ public:
        */
       const bool is_start_or_follow( char_type chr )
       {
-          return is_start( chr ) || is_follow( chr );
+          return m_tokenizer->m_classes.is( chr, CharClasses::token );
       }
 
       /**
@@ -251,6 +351,7 @@ public:
    basic_tokenizer( std::istream& is )
    : m_is( is )
    , m_skip_comments( false )
+   , m_lowercase( false )
    {
       ;
    }
@@ -284,7 +385,7 @@ public:
     */
    void add_to_start_set( std::string const& set )
    {
-      m_start += set;
+      m_classes.add( set, CharClasses::start );
    }
 
    /**
@@ -292,7 +393,7 @@ public:
     */
    void add_to_followset( std::string const& set )
    {
-      m_follow += set;
+      m_classes.add( set, CharClasses::follow );
    }
 
    /**
@@ -320,23 +421,550 @@ private:
    bool m_lowercase;
 
    /**
-    * additional follow set.
+    * the start, follow and comment character classes.
+    */
+   CharClasses m_classes;
+};
+
+/**
+ * tokenizer for char character type.
+ */
+typedef basic_tokenizer< char > Tokenizer;
+
+template < typename C >
+class basic_token_batch;
+
+/**
+ * separate a contiguous character range, such as a memory-mapped file, into
+ * token, line number pairs; tokens are views into the range.
+ */
+template < typename C >
+class basic_range_tokenizer : private UnCopyable
+{
+public:
+   /**
+    * the character type.
+    */
+   typedef C char_type;
+
+   /**
+    * the class type.
+    */
+   typedef basic_range_tokenizer class_type;
+
+   /**
+    * the line number type.
+    */
+   typedef int line_number_type;
+
+   /**
+    * the token type.
+    */
+   typedef basic_token_view< char_type > token_type;
+
+   /**
+    * the token--line number pair type.
+    */
+   typedef Pair< token_type, line_number_type > value_type;
+
+   /**
+    * the iterator type.
+    */
+   class iterator
+   {
+   public:
+      typedef std::input_iterator_tag            iterator_category;
+      typedef basic_range_tokenizer::value_type  value_type;
+      typedef std::ptrdiff_t                     difference_type;
+      typedef value_type const*                  pointer;
+      typedef value_type const&                  reference;
+
+      /**
+       * the class type.
+       */
+      typedef iterator class_type;
+
+      /**
+       * constructor.
+       */
+      explicit iterator( basic_range_tokenizer& tokenizer )
+      : m_pos      ( tokenizer.m_first )
+      , m_last     ( tokenizer.m_last  )
+      , m_tokenizer( &tokenizer        )
+      , m_value    ( token_type(), 1   )
+      , m_hash     ( hash_basis        )
+      {
+         operator++();
+      }
+
+      /**
+       * default constructor.
+       */
+      iterator()
+      : m_pos      ( NULL )
+      , m_last     ( NULL )
+      , m_tokenizer( NULL )
+      , m_value    ( token_type(), 0 )
+      , m_hash     ( hash_basis )
+      {
+      }
+
+      /**
+       * advance to next token.
+       */
+      class_type& operator++ ()
+      {
+         assert( NULL != m_pos );
+
+         char_type const* first = NULL;
+         char_type const* pos   = NULL;
+         long newlines = 0;
+
+         bool const found = m_tokenizer->next_token( m_pos, first, pos, newlines );
+
+         m_value.second += newlines;
+
+         /*
+          * signal end of input:
+          */
+         if ( !found )
+         {
+            m_pos = NULL;
+            return *this;
+         }
+
+         m_pos = pos;
+
+         /*
+          * transform to lowercase? (copy, the range is read-only);
+          * hash the token in the same pass:
+          */
+         if ( m_tokenizer->m_lowercase )
+         {
+            m_lower.resize( pos - first );
+            m_hash = to_lower( first, pos, &m_lower[ 0 ] );
+
+            m_value.first = token_type( m_lower.data(), m_lower.data() + m_lower.size() );
+         }
+         else
+         {
+            m_value.first = token_type( first, pos );
+            m_hash = hash_bytes( first, pos );
+         }
+
+         return *this;
+      }
+
+      /**
+       * the hash of the current token, see hash_bytes().
+       */
+      const hash_type hash() const
+      {
+         return m_hash;
+      }
+
+      /**
+       * return current token view, line number pair.
+       */
+      value_type const& operator*() const
+      {
+         return m_value;
+      }
+
+      /**
+       * true if this and other iterators are unequal.
+       */
+      const bool operator!= ( class_type const& rhs ) const
+      {
+          return m_pos != rhs.m_pos;
+      }
+
+   private:
+      /**
+       * the current position; NULL if end-of-input has been reached.
+       */
+      char_type const* m_pos;
+
+      /**
+       * the end of input.
+       */
+      char_type const* m_last;
+
+      /**
+       * the tokenizer (character sets and flags).
+       */
+      basic_range_tokenizer const* m_tokenizer;
+
+      /**
+       * current token view and line number.
+       */
+      value_type m_value;
+
+      /**
+       * hash of current token.
+       */
+      hash_type m_hash;
+
+      /**
+       * lowercase copy of current token.
+       */
+      std::basic_string< char_type > m_lower;
+   };
+
+   /**
+    * constructor.
+    */
+   basic_range_tokenizer( char_type const* first, char_type const* last )
+   : m_first( first )
+   , m_last ( last  )
+   , m_skip_comments( false )
+   , m_lowercase( false )
+   , m_classes()
+   , m_stop_set ( m_classes.byte_set( CharClasses::start ) )
+   , m_token_set( m_classes.byte_set( CharClasses::token ) )
+   {
+      ;
+   }
+
+   /**
+    * return collection's begin iterator.
+    */
+   iterator begin()
+   {
+      prepare();
+
+      return m_first != m_last ? iterator( *this ) : end();
+   }
+
+   /**
+    * return collection's end iterator.
+    */
+   iterator end()
+   {
+      return iterator();
+   }
+
+   /**
+    * set or clear skip-comments flag.
+    */
+   void set_skip_comments( const bool skip = true )
+   {
+      m_skip_comments = skip;
+   }
+
+   /**
+    * add given set of characters to the the start symbol set.
+    */
+   void add_to_start_set( std::string const& set )
+   {
+      m_classes.add( set, CharClasses::start );
+   }
+
+   /**
+    * add given set of characters to the the follow symbol set.
+    */
+   void add_to_followset( std::string const& set )
+   {
+      m_classes.add( set, CharClasses::follow );
+   }
+
+   /**
+    * set or clear the convert-to-lowercase flag.
+    */
+   void set_lowercase( const bool lowercase )
+   {
+      m_lowercase = lowercase;
+   }
+
+private:
+   /**
+    * the batch tokenizer uses the scanning functions.
+    */
+   friend class basic_token_batch< char_type >;
+
+   /**
+    * set up the character sets for the current classes and flags.
+    */
+   void prepare()
+   {
+      m_stop_set  = m_classes.byte_set( CharClasses::start | ( m_skip_comments ? CharClasses::comment : CharClasses::none ) );
+      m_token_set = m_classes.byte_set( CharClasses::token );
+   }
+
+   /**
+    * find the first token in [pos, end of input) and set [first, last) to it;
+    * add the number of newlines before it to newlines. False if there is none.
+    */
+   const bool next_token( char_type const* pos, char_type const*& first, char_type const*& last, long& newlines ) const
+   {
+      /*
+       * skip non-start characters:
+       */
+      for ( ;; )
+      {
+         // next start (or comment) character, counting the lines passed:
+         pos = find_in_set( pos, m_last, m_stop_set, newlines );
+
+         if ( pos == m_last || m_classes.is( *pos, CharClasses::start ) )
+         {
+            break;
+         }
+
+         // skip line comment; its newline is counted by the next search:
+         pos = find_newline( pos, m_last );
+      }
+
+      if ( pos == m_last )
+      {
+         return false;
+      }
+
+      /*
+       * scan token:
+       */
+      first = pos;
+      last  = find_not_in_set( pos, m_last, m_token_set );
+
+      return true;
+   }
+
+   /**
+    * copy [first, last) transformed to lowercase to, and return the hash of the copy.
+    */
+   static const hash_type to_lower( char_type const* first, char_type const* last, char_type* to )
+   {
+      hash_type hash = hash_basis;
+
+      for ( ; first != last; ++first, ++to )
+      {
+         *to  = static_cast< char_type >( tolower( static_cast< unsigned char >( *first ) ) );
+         hash = hash_add( hash, *to );
+      }
+      return hash;
+   }
+
+   /**
+    * begin of input.
+    */
+   char_type const* m_first;
+
+   /**
+    * end of input.
+    */
+   char_type const* m_last;
+
+   /**
+    * skip comments flag.
+    */
+   bool m_skip_comments;
+
+   /**
+    * transform tokens to lowercase.
+    */
+   bool m_lowercase;
+
+   /**
+    * the start, follow and comment character classes.
+    */
+   CharClasses m_classes;
+
+   /**
+    * the characters that end skipping: start and (optionally) comment characters.
     */
-   std::string m_start;
+   ByteSet m_stop_set;
 
    /**
-    * additional follow set.
+    * the characters of a token: start and follow characters.
     */
-   std::string m_follow;
+   ByteSet m_token_set;
 };
 
 /**
- * tokenizer for char character type.
+ * range tokenizer for char character type.
  */
-typedef basic_tokenizer< char > Tokenizer;
+typedef basic_range_tokenizer< char > RangeTokenizer;
+
+/**
+ * tokenize a range in batches: each fill() collects the next tokens of a
+ * range tokenizer as (offset, length, line, hash) records in a reusable
+ * array, so that consumers can process them in a tight loop and look ahead,
+ * e.g. to prefetch their hash table slots.
+ */
+template < typename C >
+class basic_token_batch : private UnCopyable
+{
+public:
+   /**
+    * the character type.
+    */
+   typedef C char_type;
+
+   /**
+    * the line number type.
+    */
+   typedef int line_number_type;
+
+   /**
+    * the token type.
+    */
+   typedef basic_token_view< char_type > token_type;
+
+   /**
+    * a token of the batch.
+    */
+   struct record_type
+   {
+      std::size_t      offset;  ///< position of the token in text()
+      unsigned int     length;  ///< number of characters of the token
+      line_number_type line;    ///< line number of the token
+      hash_type        hash;    ///< hash of the token, see hash_bytes()
+   };
+
+   /**
+    * the default number of tokens per batch.
+    */
+   enum { default_capacity = 256 };
+
+   /**
+    * constructor; the tokenizer's classes and flags must be set.
+    */
+   explicit basic_token_batch( basic_range_tokenizer< char_type >& tokenizer, std::size_t const capacity = default_capacity )
+   : m_tokenizer( &tokenizer )
+   , m_pos      ( tokenizer.m_first )
+   , m_line     ( 1 )
+   , m_capacity ( capacity )
+   {
+      m_tokenizer->prepare();
+      m_records.reserve( m_capacity );
+   }
+
+   /**
+    * collect the next tokens; false if there are none left.
+    */
+   const bool fill()
+   {
+      m_records.clear();
+      m_lower.clear();
+
+      record_type record;
+      char_type const* first = NULL;
+      char_type const* last  = NULL;
+      long newlines = 0;
+
+      while ( m_records.size() < m_capacity && m_tokenizer->next_token( m_pos, first, last, newlines ) )
+      {
+         m_pos = last;
+
+         record.length = static_cast< unsigned int >( last - first );
+         record.line   = m_line + static_cast< line_number_type >( newlines );
+
+         /*
+          * lowercase tokens are copied, one after the other:
+          */
+         if ( m_tokenizer->m_lowercase )
+         {
+            record.offset = m_lower.size();
+            m_lower.resize( m_lower.size() + record.length );
+            record.hash   = basic_range_tokenizer< char_type >::to_lower( first, last, &m_lower[ record.offset ] );
+         }
+         else
+         {
+            record.offset = first - m_tokenizer->m_first;
+            record.hash   = hash_bytes( first, last );
+         }
+
+         m_records.push_back( record );
+      }
+
+      m_line += static_cast< line_number_type >( newlines );
+
+      return !m_records.empty();
+   }
+
+   /**
+    * number of tokens in the batch.
+    */
+   const std::size_t size() const
+   {
+      return m_records.size();
+   }
+
+   /**
+    * true if the batch has no tokens.
+    */
+   const bool empty() const
+   {
+      return m_records.empty();
+   }
+
+   /**
+    * the record of the i-th token.
+    */
+   record_type const& operator[]( std::size_t const i ) const
+   {
+      return m_records[ i ];
+   }
+
+   /**
+    * the characters the records' offsets refer to: the range, or the
+    * lowercase copies of the tokens.
+    */
+   char_type const* text() const
+   {
+      return m_tokenizer->m_lowercase ? m_lower.data() : m_tokenizer->m_first;
+   }
+
+   /**
+    * the i-th token.
+    */
+   token_type token( std::size_t const i ) const
+   {
+      char_type const* const first = text() + m_records[ i ].offset;
+
+      return token_type( first, first + m_records[ i ].length );
+   }
+
+private:
+   /**
+    * the tokenizer (range, character sets and flags).
+    */
+   basic_range_tokenizer< char_type >* m_tokenizer;
+
+   /**
+    * where to continue tokenizing.
+    */
+   char_type const* m_pos;
+
+   /**
+    * the line number at m_pos.
+    */
+   line_number_type m_line;
+
+   /**
+    * the maximum number of tokens per batch.
+    */
+   std::size_t m_capacity;
+
+   /**
+    * the token records.
+    */
+   std::vector< record_type > m_records;
+
+   /**
+    * lowercase copies of the tokens.
+    */
+   std::basic_string< char_type > m_lower;
+};
+
+/**
+ * token batch for char character type.
+ */
+typedef basic_token_batch< char > TokenBatch;
 
 } // namespace wordindex
 
+#endif // tokenizer_h_included
+
 /*
  * end of file
  */
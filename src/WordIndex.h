@@ -29,71 +29,30 @@
 #ifndef wordindex_h_included
 #define wordindex_h_included
 
+#include "Dictionary.h" // for class wordindex::Dictionary
+#include "Hash.h"    // for hash_string()
 #include "Pair.h"    // for class wordindex::Pair<>
+#include "Postings.h" // for class wordindex::Postings
 #include "Utility.h" // for class wordindex::UnCopyable
 
-#include <map>       // for std::map<> (associative array)
+#include <algorithm> // for std::sort(), std::lower_bound()
+#include <cstddef>   // for std::ptrdiff_t
+#include <iterator>  // for std::forward_iterator_tag
 #include <vector>    // for std::vector (list if line numbers)
 #include <string>    // for std::string
 
 namespace wordindex {
 
-// TODO (Martin#1#): localized sorting?
-/**
- * std::string comparator for use in map.
- */
-class StringLess
-{
-public:
-  /**
-   * apply.
-   */
-   virtual const bool operator()( std::string const& s1, std::string const& s2 ) const
-   {
-      return s1 < s2;
-   }
-};
-
-/**
- * std::string comparator for use in map.
- */
-class NoCaseLess : public StringLess
-{
-public:
-  /**
-   * apply.
-   */
-   virtual const bool operator()( std::string const& s1, std::string const& s2 ) const
-   {
-      return std::lexicographical_compare
-      (
-         s1.begin(), s1.end(),
-         s2.begin(), s2.end(),
-         nocase_less
-      );
-   }
-
-private:
-  /**
-   * character comparator for std::lexicographical_compare().
-   */
-   static const bool nocase_less( char const c1, char const c2 )
-   {
-       return toupper( c1 ) < toupper( c2 );
-   }
-};
-
 /**
  * collect tokens with their associated line numbers.
+ *
+ * Words are interned in a dictionary that numbers them in order of arrival;
+ * the line numbers are kept per word number. The vocabulary is sorted only
+ * once iteration asks for it.
  */
 class WordIndex : private UnCopyable
 {
 private:
-   /**
-    * the word type.
-    */
-   typedef std::string word_type;
-
    /**
     * the line number type.
     */
@@ -102,12 +61,12 @@ private:
    /**
     * the list of line numbers type.
     */
-   typedef std::vector< line_number_type > locations_type;
+   typedef Postings locations_type;
 
    /**
-    * the token--locations associative array (map).
+    * the word number type.
     */
-   typedef std::map< word_type, locations_type, StringLess > map_type;
+   typedef Dictionary::id_type id_type;
 
 public:
    /**
@@ -116,35 +75,182 @@ public:
    typedef WordIndex class_type;
 
    /**
-    * this value type.
+    * the word type: a view into the dictionary.
+    */
+   typedef Dictionary::word_type word_type;
+
+   /**
+    * the occurrence count type.
+    */
+   typedef unsigned long long count_type;
+
+   /**
+    * this value type: a word with its line numbers and number of occurrences.
     */
-   typedef map_type::value_type value_type;
+   struct value_type
+   {
+      /**
+       * constructor.
+       */
+      value_type( word_type const& word, locations_type const& lines, count_type const n )
+      : first ( word  )
+      , second( lines )
+      , count ( n     )
+      {
+         ;
+      }
+
+      word_type             first;  ///< the word
+      locations_type const& second; ///< the word's line numbers; empty when only counting
+      count_type            count;  ///< the word's number of occurrences
+   };
 
    /**
     * the token--line number pair type.
     */
-   typedef Pair< word_type, line_number_type > token_type;
+   typedef Pair< std::string, line_number_type > token_type;
 
    /**
-    * the string--line numbers map iterator type.
+    * const iterator over the words in sorted order.
     */
-   typedef map_type::iterator iterator;
+   class const_iterator
+   {
+   public:
+      /**
+       * pointer to a value that lives as long as the pointer.
+       */
+      class pointer
+      {
+      public:
+         explicit pointer( value_type const& value ) : m_value( value ) { ; }
+
+         value_type const* operator->() const { return &m_value; }
+
+      private:
+         value_type m_value;
+      };
+
+      typedef std::forward_iterator_tag iterator_category;
+      typedef WordIndex::value_type     value_type;
+      typedef std::ptrdiff_t            difference_type;
+      typedef value_type                reference;
+
+      /**
+       * default constructor.
+       */
+      const_iterator()
+      : m_pos( NULL )
+      , m_index( NULL )
+      {
+      }
+
+      /**
+       * constructor.
+       */
+      const_iterator( id_type const* pos, WordIndex const* index )
+      : m_pos( pos )
+      , m_index( index )
+      {
+      }
+
+      /**
+       * the current entry.
+       */
+      reference operator*() const
+      {
+         return m_index->entry( *m_pos );
+      }
+
+      /**
+       * the current entry.
+       */
+      pointer operator->() const
+      {
+         return pointer( m_index->entry( *m_pos ) );
+      }
+
+      /**
+       * advance to next entry.
+       */
+      const_iterator& operator++()
+      {
+         ++m_pos;
+         return *this;
+      }
+
+      /**
+       * advance to next entry.
+       */
+      const_iterator operator++( int )
+      {
+         const_iterator result( *this );
+         ++m_pos;
+         return result;
+      }
+
+      /**
+       * advance the given number of entries.
+       */
+      const_iterator& operator+=( difference_type const n )
+      {
+         m_pos += n;
+         return *this;
+      }
+
+      /**
+       * true if this and other iterators are equal.
+       */
+      const bool operator==( const_iterator const& rhs ) const
+      {
+         return m_pos == rhs.m_pos;
+      }
+
+      /**
+       * true if this and other iterators are unequal.
+       */
+      const bool operator!=( const_iterator const& rhs ) const
+      {
+         return m_pos != rhs.m_pos;
+      }
+
+   private:
+      id_type const*   m_pos;     ///< position in the sorted order
+      WordIndex const* m_index;   ///< the index
+   };
 
    /**
-    * the string--line numbers map const iterator type.
+    * the iterator type (read-only).
     */
-   typedef map_type::const_iterator const_iterator;
+   typedef const_iterator iterator;
 
    /**
     * constructor.
     */
    WordIndex()
    : m_lines( 0 )
-   , m_words( NoCaseLess() )
+   , m_count_only( false )
+   , m_sorted( true )
    {
       ;
    }
 
+   /**
+    * true if only the occurrences of words are counted.
+    */
+   const bool count_only() const
+   {
+      return m_count_only;
+   }
+
+   /**
+    * only count the occurrences of words, do not keep their line numbers;
+    * set before adding words.
+    */
+   void set_count_only( bool const count_only = true )
+   {
+      m_count_only = count_only;
+   }
+
    /**
     * const begin iterator.
     */
@@ -154,11 +260,12 @@ public:
    }
 
    /**
-    * const begin iterator.
+    * const begin iterator; sorts the vocabulary if words were added.
     */
    const_iterator const_begin() const
    {
-      return m_words.begin();
+      sort();
+      return const_iterator( m_order.empty() ? NULL : &m_order[ 0 ], this );
    }
 
    /**
@@ -174,7 +281,25 @@ public:
     */
    const_iterator const_end() const
    {
-      return m_words.end();
+      sort();
+      return const_iterator( m_order.empty() ? NULL : &m_order[ 0 ] + m_order.size(), this );
+   }
+
+   /**
+    * the given word; end() if not present. The word is looked up by hash
+    * and then located in the sorted vocabulary by binary search.
+    */
+   const_iterator find( std::string const& word ) const
+   {
+      id_type const id = m_words.find( word.data(), word.data() + word.size(), hash_string( word ) );
+
+      if ( Dictionary::npos == id )
+      {
+         return end();
+      }
+
+      sort();
+      return const_iterator( &*std::lower_bound( m_order.begin(), m_order.end(), id, IdLess( m_words ) ), this );
    }
 
    /**
@@ -196,10 +321,118 @@ public:
    /**
     * add a token and line number.
     */
-   void insert( std::string const s, line_number_type const n )
+   void insert( std::string const& s, line_number_type const n )
+   {
+      insert( word_type( s.data(), s.data() + s.size() ), hash_string( s ), n );
+   }
+
+   /**
+    * start loading what adding a token with the given hash needs.
+    */
+   void prefetch( hash_type const hash ) const
+   {
+      m_words.prefetch( hash );
+   }
+
+   /**
+    * add a token with its hash, see hash_bytes(), and line number.
+    */
+   void insert( word_type const& word, hash_type const hash, line_number_type const n )
    {
+      id_type const id = intern( word.begin(), word.end(), hash );
+
       ++m_lines;
-      m_words[ s ].push_back( n );
+
+      if ( m_count_only )
+      {
+         ++m_counts[ id ];
+      }
+      else
+      {
+         m_locations[ id ].push_back( n );
+      }
+   }
+
+   /**
+    * add a token with the given sequence of line numbers.
+    */
+   template < typename InputIterator >
+   void insert( std::string const& s, InputIterator first, InputIterator last )
+   {
+      insert( word_type( s.data(), s.data() + s.size() ), hash_string( s ), first, last );
+   }
+
+   /**
+    * add a token with its hash, see hash_bytes(), with the given sequence of line numbers.
+    */
+   template < typename InputIterator >
+   void insert( word_type const& word, hash_type const hash, InputIterator first, InputIterator last )
+   {
+      id_type const id = intern( word.begin(), word.end(), hash );
+
+      for ( ; first != last; ++first, ++m_lines )
+      {
+         if ( m_count_only )
+         {
+            ++m_counts[ id ];
+         }
+         else
+         {
+            m_locations[ id ].push_back( *first );
+         }
+      }
+   }
+
+   /**
+    * move the words of another index to this index; locations of words present
+    * in both follow the locations already present. The other index is left empty.
+    */
+   void splice( WordIndex& other )
+   {
+      for ( id_type id = 0; id < other.m_words.size(); ++id )
+      {
+         word_type const word = other.m_words.word( id );
+         id_type const to = intern( word.begin(), word.end(), other.m_words.hash( id ) );
+
+         if ( !m_count_only && !other.m_count_only && m_locations[ to ].empty() )
+         {
+            m_locations[ to ].swap( other.m_locations[ id ] );
+         }
+         else
+         {
+            add( to, other, id, 0 );
+         }
+      }
+      m_lines += other.m_lines;
+
+      other.clear();
+   }
+
+   /**
+    * add the tokens of another index, with the given offset added to their line numbers;
+    * the other index's locations follow the locations already present.
+    */
+   void append( WordIndex const& other, line_number_type const offset = 0 )
+   {
+      for ( id_type id = 0; id < other.m_words.size(); ++id )
+      {
+         word_type const word = other.m_words.word( id );
+         add( intern( word.begin(), word.end(), other.m_words.hash( id ) ), other, id, offset );
+      }
+      m_lines += other.m_lines;
+   }
+
+   /**
+    * remove all words; the counting mode is kept.
+    */
+   void clear()
+   {
+      m_lines = 0;
+      m_words.clear();
+      m_locations.clear();
+      m_counts.clear();
+      m_order.clear();
+      m_sorted = true;
    }
 
    /**
@@ -213,21 +446,150 @@ public:
    /**
     * number of line references.
     */
-   const int lines() const
+   const count_type lines() const
    {
       return m_lines;
    }
 
+   /**
+    * number of bytes used by the compressed line numbers.
+    */
+   const std::size_t postings_size() const
+   {
+      std::size_t size = 0;
+
+      for ( std::vector< locations_type >::const_iterator pos = m_locations.begin(); pos != m_locations.end(); ++pos )
+      {
+         size += pos->encoded_size();
+      }
+      return size;
+   }
+
 private:
+   /**
+    * the entry of the given word number.
+    */
+   value_type entry( id_type const id ) const
+   {
+      static locations_type const none;
+
+      return m_count_only
+         ? value_type( m_words.word( id ), none, m_counts[ id ] )
+         : value_type( m_words.word( id ), m_locations[ id ], m_locations[ id ].size() );
+   }
+
+   /**
+    * the number of the word [first, last) with the given hash, added if not present.
+    */
+   const id_type intern( char const* first, char const* last, hash_type const hash )
+   {
+      bool added = false;
+      id_type const id = m_words.intern( first, last, hash, added );
+
+      if ( added )
+      {
+         if ( m_count_only )
+         {
+            m_counts.push_back( 0 );
+         }
+         else
+         {
+            m_locations.push_back( locations_type() );
+         }
+         m_sorted = false;
+      }
+      return id;
+   }
+
+   /**
+    * add the occurrences of word id of another index to word to of this index,
+    * with the given offset added to their line numbers; an index that only
+    * counts contributes no line numbers.
+    */
+   void add( id_type const to, WordIndex const& other, id_type const id, line_number_type const offset )
+   {
+      if ( m_count_only )
+      {
+         m_counts[ to ] += other.entry( id ).count;
+      }
+      else if ( !other.m_count_only )
+      {
+         m_locations[ to ].append( other.m_locations[ id ], offset );
+      }
+   }
+
+   /**
+    * word number order on word.
+    */
+   class IdLess
+   {
+   public:
+      IdLess( Dictionary const& words ) : m_words( &words ) { ; }
+
+      bool operator()( id_type const a, id_type const b ) const
+      {
+         return m_words->less( a, b );
+      }
+
+   private:
+      Dictionary const* m_words;
+   };
+
+   /**
+    * sort the vocabulary, if words were added since the last sort.
+    */
+   void sort() const
+   {
+      if ( m_sorted )
+      {
+         return;
+      }
+
+      m_order.resize( m_words.size() );
+
+      for ( id_type id = 0; id < m_order.size(); ++id )
+      {
+         m_order[ id ] = id;
+      }
+
+      std::sort( m_order.begin(), m_order.end(), IdLess( m_words ) );
+      m_sorted = true;
+   }
+
    /**
     * number of line references.
     */
-   int m_lines;
+   count_type m_lines;
+
+   /**
+    * true if only the occurrences of words are counted.
+    */
+   bool m_count_only;
+
+   /**
+    * the words.
+    */
+   Dictionary m_words;
+
+   /**
+    * the compressed line numbers of each word, by word number.
+    */
+   std::vector< locations_type > m_locations;
+
+   /**
+    * the number of occurrences of each word, by word number, when only counting.
+    */
+   std::vector< count_type > m_counts;
+
+   /**
+    * the word numbers in word order, see sort().
+    */
+   mutable std::vector< id_type > m_order;
 
    /**
-    * datastructure: a map of token--list of linenumbers pairs (associative array).
+    * true if m_order is up to date.
     */
-   map_type m_words;
+   mutable bool m_sorted;
 };
 
 /**
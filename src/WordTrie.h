@@ -0,0 +1,625 @@
+/*
+ * WordTrie.h - compacted trie of a sorted vocabulary for prefix and wildcard queries.
+ *
+ * This file is part of WordIndex.
+ *
+ * Copyright (C) 2007-2020, Martin J. Moene.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with mngdriver; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/**
+ * \file
+ */
+
+#ifndef wordtrie_h_included
+#define wordtrie_h_included
+
+#include "TokenView.h"  // for class TokenView
+#include "Utility.h"    // for class UnCopyable
+
+#include <algorithm>    // for std::sort(), std::unique()
+#include <cstddef>      // for std::size_t
+#include <deque>        // for std::deque<>
+#include <string>       // for std::string
+#include <utility>      // for std::pair<>
+#include <vector>       // for std::vector<>
+
+namespace wordindex {
+
+/**
+ * compacted trie (radix tree) of a sorted list of distinct words, that gives
+ * the numbers (positions in the list) of the words with a given prefix or
+ * that match a wildcard pattern, without looking at the other words.
+ *
+ * A node stands for the common prefix of a range of words; its label is the
+ * part of that prefix below its parent, and its children split the range on
+ * the next character. As the words are sorted, the words of a node form the
+ * contiguous range [first, last) of word numbers, and a node ends a word if
+ * it has no children or its first child starts after its first word.
+ *
+ * The nodes are numbered breadth first, so that the children of a node as
+ * well as the labels of the nodes are consecutive and are found from the
+ * next node's offsets: per node four numbers and its label characters, as
+ * the common prefixes are stored once. The numbers and characters are made
+ * here, or are used where they are kept, such as in a mapped index file.
+ */
+class WordTrie : private UnCopyable
+{
+public:
+   /**
+    * the word number and size type.
+    */
+   typedef unsigned int size_type;
+
+   /**
+    * a range [first, last) of word numbers.
+    */
+   typedef std::pair< size_type, size_type > range_type;
+
+   /**
+    * the list of word numbers type.
+    */
+   typedef std::vector< size_type > numbers_type;
+
+   /**
+    * true if the given text contains wildcards: '*' for any characters, '?' for one.
+    */
+   static const bool is_pattern( std::string const& text )
+   {
+      return std::string::npos != text.find_first_of( "*?" );
+   }
+
+   /**
+    * the number of numbers of a trie of the given number of nodes, see numbers().
+    */
+   static const std::size_t numbers_size( size_type const nodes )
+   {
+      return 4 * static_cast< std::size_t >( nodes ) + 2;
+   }
+
+   /**
+    * default constructor; a trie without words.
+    */
+   WordTrie()
+   {
+      std::vector< TokenView > const none;
+      build( none );
+   }
+
+   /**
+    * constructor; the given words, which must be in order and distinct.
+    */
+   explicit WordTrie( std::vector< std::string > const& words )
+   {
+      std::vector< TokenView > views;
+
+      for ( std::vector< std::string >::const_iterator pos = words.begin(); pos != words.end(); ++pos )
+      {
+         views.push_back( TokenView( pos->data(), pos->data() + pos->size() ) );
+      }
+
+      build( views );
+   }
+
+   /**
+    * make the trie of the given words, which must be in order and distinct.
+    */
+   void assign( std::vector< TokenView > const& words )
+   {
+      build( words );
+   }
+
+   /**
+    * make the trie of the words of the entries in [first, last), which must be
+    * in order and distinct, such as the entries of a word index or index file.
+    */
+   template < typename I >
+   void assign( I first, I last )
+   {
+      std::vector< TokenView > words;
+
+      for ( ; first != last; ++first )
+      {
+         words.push_back( (*first).first );
+      }
+
+      build( words );
+   }
+
+   /**
+    * use the trie of the given number of nodes kept elsewhere, as given by
+    * numbers() and chars() of a trie of the given number of words; the memory
+    * must outlive this trie. Only the outline is checked here, so that this
+    * takes no time; nodes are checked as visited. False if damaged.
+    */
+   const bool attach( size_type const nodes, size_type const* numbers, char const* chars, std::size_t const chars_size, size_type const words )
+   {
+      size_type const* const labels   = numbers;
+      size_type const* const children = labels + nodes + 1;
+      size_type const* const first    = children + nodes + 1;
+      size_type const* const last     = first + nodes;
+
+      if ( 0 != labels[ 0 ] || labels[ nodes ] != chars_size
+         || ( 0 == nodes ? 0 != words : 0 != first[ 0 ] || words != last[ 0 ] ) )
+      {
+         return false;
+      }
+
+      m_made_numbers.clear();
+      m_made_chars.clear();
+
+      m_nodes    = nodes;
+      m_words    = words;
+      m_labels   = labels;
+      m_children = children;
+      m_first    = first;
+      m_last     = last;
+      m_chars    = chars;
+
+      return true;
+   }
+
+   /**
+    * number of words.
+    */
+   const size_type words() const
+   {
+      return m_words;
+   }
+
+   /**
+    * number of nodes.
+    */
+   const size_type nodes() const
+   {
+      return m_nodes;
+   }
+
+   /**
+    * the numbers_size( nodes() ) numbers of the nodes: the offsets of their labels
+    * and of their children, and the ranges of their words.
+    */
+   size_type const* numbers() const
+   {
+      return m_labels;
+   }
+
+   /**
+    * the characters of the labels of the nodes.
+    */
+   char const* chars() const
+   {
+      return m_chars;
+   }
+
+   /**
+    * the number of characters of the labels of the nodes.
+    */
+   const std::size_t chars_size() const
+   {
+      return m_labels[ m_nodes ];
+   }
+
+   /**
+    * number of bytes the trie occupies.
+    */
+   const std::size_t size_in_bytes() const
+   {
+      return chars_size() + sizeof( size_type ) * numbers_size( m_nodes );
+   }
+
+   /**
+    * the numbers of the words that start with the given prefix.
+    */
+   range_type prefix_range( std::string const& prefix ) const
+   {
+      size_type node = 0;
+      std::size_t pos = 0;
+
+      while ( m_nodes > 0 )
+      {
+         char const* label = label_begin( node );
+         char const* const end = label + label_size( node );
+
+         for ( ; label != end && pos < prefix.size(); ++label, ++pos )
+         {
+            if ( *label != prefix[ pos ] )
+            {
+               return range_type( 0, 0 );
+            }
+         }
+
+         if ( pos == prefix.size() )
+         {
+            return word_range( node );
+         }
+
+         node = child( node, prefix[ pos ] );
+
+         if ( 0 == node )
+         {
+            break;
+         }
+      }
+      return range_type( 0, 0 );
+   }
+
+   /**
+    * the numbers of the words that match the given pattern, in order:
+    * '*' matches any characters, '?' any one character, others themselves.
+    * The trie is walked once, with the set of positions in the pattern that
+    * the characters so far lead to, so that each node is visited once,
+    * however many ways the stars can expand.
+    */
+   void match( std::string const& pattern, numbers_type& result ) const
+   {
+      result.clear();
+
+      if ( m_nodes > 0 )
+      {
+         positions_type positions( pattern.size() + 1, 0 );
+         reach( pattern, 0, positions );
+
+         match( 0, pattern, positions, result );
+      }
+   }
+
+private:
+   /**
+    * a set of positions in a pattern: a flag per position, and one for the
+    * end of the pattern.
+    */
+   typedef std::vector< char > positions_type;
+
+   /**
+    * a node yet to make: its range of words and the length of the prefix of its parent.
+    */
+   struct Pending
+   {
+      size_type   first;   ///< first word number
+      size_type   last;    ///< end word number
+      std::size_t depth;   ///< the length of the prefix of the parent
+   };
+
+   /**
+    * make the trie of the given words, breadth first.
+    */
+   void build( std::vector< TokenView > const& words )
+   {
+      std::vector< size_type > labels( 1, 0 );
+      std::vector< size_type > children( 1, 1 );
+      std::vector< size_type > first;
+      std::vector< size_type > last;
+
+      m_made_chars.clear();
+
+      // the nodes yet to make:
+      std::deque< Pending > queue;
+
+      if ( !words.empty() )
+      {
+         Pending const root = { 0, static_cast< size_type >( words.size() ), 0 };
+         queue.push_back( root );
+      }
+
+      while ( !queue.empty() )
+      {
+         Pending const range = queue.front();
+         queue.pop_front();
+
+         char const* const lo = words[ range.first ].begin();
+         char const* const hi = words[ range.last - 1 ].begin();
+
+         std::size_t const lo_size = words[ range.first ].size();
+         std::size_t const hi_size = words[ range.last - 1 ].size();
+
+         // the common prefix of a sorted range is that of its first and last words:
+         std::size_t prefix = range.depth;
+
+         while ( prefix < lo_size && prefix < hi_size && lo[ prefix ] == hi[ prefix ] )
+         {
+            ++prefix;
+         }
+
+         m_made_chars.insert( m_made_chars.end(), lo + range.depth, lo + prefix );
+         labels.push_back( static_cast< size_type >( m_made_chars.size() ) );
+         first.push_back( range.first );
+         last.push_back( range.last );
+
+         // the children: groups of words on the character after the prefix:
+         size_type next = range.first + ( lo_size == prefix ? 1 : 0 );
+         size_type count = 0;
+
+         while ( next < range.last )
+         {
+            char const chr = words[ next ].begin()[ prefix ];
+            size_type end = next + 1;
+
+            while ( end < range.last && words[ end ].begin()[ prefix ] == chr )
+            {
+               ++end;
+            }
+
+            Pending const group = { next, end, prefix };
+            queue.push_back( group );
+
+            ++count;
+            next = end;
+         }
+
+         children.push_back( children.back() + count );
+      }
+
+      m_nodes = static_cast< size_type >( first.size() );
+      m_words = static_cast< size_type >( words.size() );
+
+      m_made_numbers.clear();
+      m_made_numbers.reserve( numbers_size( m_nodes ) );
+      m_made_numbers.insert( m_made_numbers.end(), labels.begin(), labels.end() );
+      m_made_numbers.insert( m_made_numbers.end(), children.begin(), children.end() );
+      m_made_numbers.insert( m_made_numbers.end(), first.begin(), first.end() );
+      m_made_numbers.insert( m_made_numbers.end(), last.begin(), last.end() );
+
+      m_labels   = &m_made_numbers[ 0 ];
+      m_children = m_labels + m_nodes + 1;
+      m_first    = m_children + m_nodes + 1;
+      m_last     = m_first + m_nodes;
+      m_chars    = m_made_chars.empty() ? NULL : &m_made_chars[ 0 ];
+   }
+
+   /**
+    * begin of the label of the given node.
+    */
+   char const* label_begin( size_type const node ) const
+   {
+      return m_chars + m_labels[ node ];
+   }
+
+   /**
+    * length of the label of the given node; 0 if damaged.
+    */
+   const std::size_t label_size( size_type const node ) const
+   {
+      size_type const first = m_labels[ node ];
+      size_type const last  = m_labels[ node + 1 ];
+
+      return first <= last && last <= m_labels[ m_nodes ] ? last - first : 0;
+   }
+
+   /**
+    * the numbers of the words of the given node; empty if damaged.
+    */
+   range_type word_range( size_type const node ) const
+   {
+      size_type const first = m_first[ node ];
+      size_type const last  = m_last[ node ];
+
+      return first <= last && last <= m_words ? range_type( first, last ) : range_type( 0, 0 );
+   }
+
+   /**
+    * the numbers [first, last) of the children of the given node; none if
+    * damaged. Children come after their parent, so that walks end.
+    */
+   range_type child_range( size_type const node ) const
+   {
+      size_type const first = m_children[ node ];
+      size_type const last  = m_children[ node + 1 ];
+
+      return node < first && first <= last && last <= m_nodes ? range_type( first, last ) : range_type( 0, 0 );
+   }
+
+   /**
+    * true if a word ends at the given node.
+    */
+   const bool is_word( size_type const node ) const
+   {
+      range_type const children = child_range( node );
+
+      return children.first == children.second || m_first[ children.first ] > m_first[ node ];
+   }
+
+   /**
+    * the child of the given node whose label starts with the given
+    * character; 0 (the root, never a child) if none. The children are in
+    * order of their first character, which is searched binary.
+    */
+   const size_type child( size_type const node, char const chr ) const
+   {
+      range_type const children = child_range( node );
+
+      size_type first = children.first;
+      size_type count = children.second - children.first;
+
+      while ( count > 0 )
+      {
+         size_type const half = count / 2;
+
+         if ( label_size( first + half ) > 0 && static_cast< unsigned char >( *label_begin( first + half ) ) < static_cast< unsigned char >( chr ) )
+         {
+            first += half + 1;
+            count -= half + 1;
+         }
+         else
+         {
+            count = half;
+         }
+      }
+
+      return first < children.second && label_size( first ) > 0 && *label_begin( first ) == chr ? first : 0;
+   }
+
+   /**
+    * add position p of the pattern to the given positions, with the positions
+    * after the stars from p on, that match no character.
+    */
+   static void reach( std::string const& pattern, std::size_t p, positions_type& positions )
+   {
+      positions[ p ] = 1;
+
+      while ( p < pattern.size() && '*' == pattern[ p ] )
+      {
+         positions[ ++p ] = 1;
+      }
+   }
+
+   /**
+    * the positions that the given character leads to from the given
+    * positions: a star matches it and stays; false if there are none.
+    */
+   static const bool step( std::string const& pattern, positions_type const& from, char const chr, positions_type& to )
+   {
+      to.assign( from.size(), 0 );
+
+      bool any = false;
+
+      for ( std::size_t p = 0; p < pattern.size(); ++p )
+      {
+         if ( !from[ p ] )
+         {
+            continue;
+         }
+
+         if ( '*' == pattern[ p ] )
+         {
+            reach( pattern, p, to );
+            any = true;
+         }
+         else if ( '?' == pattern[ p ] || pattern[ p ] == chr )
+         {
+            reach( pattern, p + 1, to );
+            any = true;
+         }
+      }
+      return any;
+   }
+
+   /**
+    * add the words below the given node that match the pattern, where the
+    * prefix of the node's parent leads to the given positions.
+    */
+   void match( size_type const node, std::string const& pattern, positions_type const& from, numbers_type& result ) const
+   {
+      std::size_t const end = pattern.size();
+      bool const trailing_star = end > 0 && '*' == pattern[ end - 1 ];
+
+      positions_type positions( from );
+      positions_type next;
+
+      char const* const label = label_begin( node );
+
+      for ( std::size_t i = 0; i < label_size( node ); ++i )
+      {
+         // the pattern has matched all but its trailing stars:
+         if ( positions[ end ] && trailing_star )
+         {
+            break;
+         }
+
+         if ( !step( pattern, positions, label[ i ], next ) )
+         {
+            return;
+         }
+         positions.swap( next );
+      }
+
+      range_type const range = word_range( node );
+
+      if ( positions[ end ] && trailing_star )
+      {
+         // all words below:
+         for ( size_type n = range.first; n < range.second; ++n )
+         {
+            result.push_back( n );
+         }
+         return;
+      }
+
+      if ( positions[ end ] && is_word( node ) && range.first < range.second )
+      {
+         result.push_back( range.first );
+      }
+
+      /*
+       * the children, in order; without a wildcard to match, only those that
+       * start with a character expected:
+       */
+      std::string expected;
+      bool wildcard = false;
+
+      for ( std::size_t p = 0; p < end; ++p )
+      {
+         if ( positions[ p ] )
+         {
+            wildcard = wildcard || '*' == pattern[ p ] || '?' == pattern[ p ];
+            expected += pattern[ p ];
+         }
+      }
+
+      if ( wildcard )
+      {
+         range_type const children = child_range( node );
+
+         for ( size_type c = children.first; c < children.second; ++c )
+         {
+            match( c, pattern, positions, result );
+         }
+         return;
+      }
+
+      std::sort( expected.begin(), expected.end(), char_less );
+      expected.erase( std::unique( expected.begin(), expected.end() ), expected.end() );
+
+      for ( std::string::const_iterator chr = expected.begin(); chr != expected.end(); ++chr )
+      {
+         size_type const c = child( node, *chr );
+
+         if ( 0 != c )
+         {
+            match( c, pattern, positions, result );
+         }
+      }
+   }
+
+   /**
+    * character order of the children: as unsigned characters.
+    */
+   static bool char_less( char const a, char const b )
+   {
+      return static_cast< unsigned char >( a ) < static_cast< unsigned char >( b );
+   }
+
+   size_type         m_nodes;      ///< number of nodes
+   size_type         m_words;      ///< number of words
+   size_type const*  m_labels;     ///< nodes + 1 offsets of the labels in m_chars
+   size_type const*  m_children;   ///< nodes + 1 numbers of the first child of each node
+   size_type const*  m_first;      ///< the first word number of each node
+   size_type const*  m_last;       ///< the end word number of each node
+   char const*       m_chars;      ///< the labels of the nodes
+
+   std::vector< size_type > m_made_numbers;  ///< the numbers, when made here
+   std::vector< char >      m_made_chars;    ///< the labels, when made here
+};
+
+} // namespace wordindex
+
+#endif // wordtrie_h_included
+
+/*
+ * end of file
+ */
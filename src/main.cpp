@@ -58,22 +58,37 @@
  * \file
  */
 
+#include "BlockReader.h" // for class BlockReader
 #include "Config.h"     // for configuration
+#include "FileLoader.h" // for class FileLoader
+#include "IndexFile.h"  // for class IndexFile, class IndexBuilder
+#include "KeywordScanner.h" // for class KeywordScanner
+#include "KeywordSet.h" // for class KeywordSet
 #include "Logger.h"     // for class Logger
+#include "MappedFile.h" // for class MappedFile, read_ahead()
+#include "Merge.h"      // for class PartialIndex, merge_parallel()
+#include "OutputBuffer.h" // for class OutputBuffer
 #include "Pair.h"       // for pair_type
+#include "Query.h"      // for class BooleanQuery
+#include "StopwordFile.h" // for class StopwordFile
+#include "Stopwords.h"  // for builtin_stopwords
+#include "Parallel.h"   // for split_lines(), run_parallel(), class WorkQueues
 #include "Tokenizer.h"  // for class Tokenizer
 #include "Utility.h"    // shims
 #include "Version.h"    // for WORDINDEX_VERSION_STRING
 #include "WordIndex.h"  // for class WordIndex
+#include "WordTrie.h"   // for class WordTrie
 
 #include <ctype.h>     // for ::isalpha()
 
 #include <algorithm> // for std::copy()
-#include <set>       // for std::ste<> (associative array)
+#include <cstdio>    // for std::remove(), std::rename()
+#include <deque>     // for std::deque<> (chunk indexes)
 #include <iterator>  // for std::iterator<> base class
-#include <iomanip>   // for std::setw() etc.
 #include <fstream>   // for std::ifstream
 #include <iostream>  // for std::cin, std::cout
+#include <map>       // for std::map<> (files of an earlier index)
+#include <sstream>   // for std::istringstream (--query)
 #include <string>    // for std::string
 //#include <utility>   // for std::pair<>
 #include <vector>    // for std::vector (list if line numbers)
@@ -159,7 +174,7 @@ typedef std::string filename_type;
 /**
  * the keyword container.
  */
-typedef std::set< word_type > keyword_collection_type;
+typedef KeywordSet keyword_collection_type;
 
 /**
  * the keyword container.
@@ -176,19 +191,6 @@ typedef Pair< filename_type, line_number_type > filename_list_element_type;
  */
 typedef std::vector< filename_list_element_type > filename_list_type;
 
-/**
- * print collections contents.
- */
-template < typename C >
-void print_collection( std::ostream& os, C const& collection )
-{
-   std::copy
-   ( collection.begin()
-   , collection.end()
-   , std::ostream_iterator< typename_type_k C::value_type >( os, "  " )
-   );
-}
-
 /**
  * the logger instance (external linkage).
  */
@@ -208,15 +210,33 @@ int usage( std::ostream& os, int status )
       "      --version       report program and compiler versions [no]\n"
       "  -v, --verbose       report ... [none]\n"
       "\n"
+      "  -c, --count         only count words, do not collect line numbers [no]\n"
       "  -f, --frequency     also report word frequency as d.dd% (n) [no]\n"
 //      "  -g, --ignorecase    handle upper and lowercase as being equivalent [no]\n"
       "  -l, --lowercase     transform words to lowercase [no]\n"
+      "  -p, --parallel      tokenize a large file and format the output in chunks, one per core [no]\n"
+      "  -j, --jobs=n        read up to n files at a time, also limits --parallel [1]\n"
       "  -r, --reverse       only collect keyword occurrences, see --keywords [no]\n"
       "  -s, --summary       also report number of (key)words and references [no]\n"
       "\n"
       "  -i, --input=file    read filenames from given file [standard input or given filenames]\n"
       "  -o, --output=file   write output to given file [standard output]\n"
-      "  -k, --keywords=file read keywords to skip (stopwords) from given file [none]\n"
+      "  -k, --keywords=file read keywords to skip (stopwords) from given text or\n"
+      "                      precompiled file [none]\n"
+      "  -b, --builtin-keywords  also skip the compiled-in keywords [no]\n"
+      "      --make-keywords=file  write the keywords as C++ header to compile in,\n"
+      "                      replacing src/Stopwords.h, and exit [no]\n"
+      "      --compile-keywords=file  write the keywords as precompiled file, and exit [no]\n"
+      "\n"
+      "      --save-index=file  write the index to given file instead of printing it,\n"
+      "                      or update it, reading only the files changed since [no]\n"
+      "      --load-index=file  print the index saved in given file, reading no text [no]\n"
+      "  -q, --query=words   only print the given words, in the order given; a word\n"
+      "                      may contain wildcards, as in 'foo*' or 'f?o*' [all words]\n"
+      "      --queries=file  only print the words read from given file [all words]\n"
+      "  -m, --match=query   only print the lines with words as queried, such as:\n"
+      "                      'foo AND ( bar OR baz ) NOT qux' [no]\n"
+      "      --matches=file  read the queries of --match from given file, one per line [no]\n"
       "\n"
       "Long options also may start with a plus, like: +help.\n"
       "\n" <<
@@ -298,251 +318,1537 @@ public:
     * constructor.
     */
    Options()
-   : frequency ( false )
+   : count     ( false )
+   , frequency ( false )
    , ignorecase( false )
    , lowercase ( false )
+   , match     ( false )
+   , parallel  ( false )
+   , query     ( false )
    , reverse   ( false )
    , summary   ( false )
    , name_width( 20 )
+   , jobs      ( 1 )
+   , threads   ( hardware_threads() )
+   , scanner   ( NULL )
    {
    }
 
+   bool count;       ///< only count words, do not collect line numbers
    bool frequency;   ///< report word usage percentage and count
    bool ignorecase;  ///< (currently not used)
    bool lowercase;   ///< convert words to lowercase
+   bool match;       ///< only print the lines that satisfy the queries of matches
+   bool parallel;    ///< tokenize large files in chunks on several threads
+   bool query;       ///< only print the words of queries
    bool reverse;     ///< only report keyword (stopword) usage
    bool summary;     ///< also report number of (key)words and references
 
    int  name_width;  ///< name field width
+   int  jobs;        ///< number of files to read at a time
+   int  threads;     ///< number of threads to tokenize a file with
+
+   std::vector< std::string > queries;  ///< the words to print, see query
+   std::vector< BooleanQuery > matches; ///< the boolean queries to print the lines of, see match
+
+   KeywordScanner const* scanner;  ///< finds the keywords in reverse mode; NULL to tokenize
 };
 
 /**
- * filename list entry exists predicate.
+ * minimum size of a file chunk to tokenize on its own thread.
  */
-void check_file_exists( filename_list_element_type const& element )
+const std::size_t min_chunk_size = 1 << 20;
+
+/**
+ * size of the blocks a stream is read in.
+ */
+const std::size_t stream_block_size = 1 << 16;
+
+/**
+ * number of tokens to look ahead when prefetching hash table slots.
+ */
+const std::size_t prefetch_distance = 8;
+
+/**
+ * report that the given filename list entry cannot be opened and exit.
+ */
+void cannot_open( filename_list_element_type const& element )
 {
    filename_type    const filename   = element.first;
    line_number_type const linenumber = element.second;
 
-   if ( !exist( filename ) )
-   {
-      if ( 0 == linenumber )
+   if ( 0 == linenumber )
+   {
+      logger.Fatal( "cannot open file '" + filename + "'." );
+   }
+   else
+   {
+      logger.Fatal( "filename list, line " + to_string( linenumber ) + ": cannot open file '" + filename + "'." );
+   }
+}
+
+/**
+ * filename list entry exists predicate.
+ */
+void check_file_exists( filename_list_element_type const& element )
+{
+   if ( !exist( element.first ) )
+   {
+      cannot_open( element );
+   }
+}
+
+/**
+ * add tokens to an index with the given offset added to their line numbers.
+ */
+template < typename I >
+class offset_inserter
+{
+public:
+   /**
+    * constructor.
+    */
+   offset_inserter( I& index, line_number_type const offset )
+   : m_index ( &index )
+   , m_offset( offset )
+   {
+      ;
+   }
+
+   /**
+    * start loading what adding a token with the given hash needs.
+    */
+   void prefetch( hash_type const hash ) const
+   {
+      m_index->prefetch( hash );
+   }
+
+   /**
+    * add a token with its hash and line number.
+    */
+   void insert( TokenView const& word, hash_type const hash, line_number_type const n )
+   {
+      m_index->insert( word, hash, n + m_offset );
+   }
+
+private:
+   I* m_index;                 ///< the index to add to
+   line_number_type m_offset;  ///< the line number offset
+};
+
+/**
+ * read words from the given character range into the given wordindex;
+ * tokens are views into the range, looked up and added with the tokenizer's
+ * hash, so that only new words are copied.
+ */
+template < typename I >
+void read_tokens( char const* first, char const* last, Options const& options, Keywords const& keywords, I& wordindex )
+{
+   /*
+    * only collect keywords: scan for them instead of tokenizing if possible:
+    */
+   if ( options.reverse && options.scanner )
+   {
+      options.scanner->scan( first, last, wordindex );
+      return;
+   }
+
+   RangeTokenizer tokenizer( first, last );
+   tokenizer.set_lowercase( options.lowercase );
+
+   TokenBatch batch( tokenizer );
+
+   while ( batch.fill() )
+   {
+      std::size_t const size = batch.size();
+
+      for ( std::size_t i = 0; i < size; ++i )
+      {
+         // look ahead: start loading the table slots of a later token:
+         if ( i + prefetch_distance < size )
+         {
+            keywords.prefetch( batch[ i + prefetch_distance ].hash );
+            wordindex.prefetch( batch[ i + prefetch_distance ].hash );
+         }
+
+         TokenBatch::record_type const& token = batch[ i ];
+         TokenView const word = batch.token( i );
+
+         // include only keywords (reverse), or only non-keywords:
+         if ( options.reverse == keywords.contains( word, token.hash ) )
+         {
+            wordindex.insert( word, token.hash, token.line );
+         }
+      }
+   }
+}
+
+/**
+ * read words from the given lines into the given wordindex, with the given
+ * line offset, and advance the offset past them.
+ */
+template < typename I >
+void read_lines( char const* first, char const* last, Options const& options, Keywords const& keywords, I& wordindex, line_number_type& offset )
+{
+   offset_inserter< I > inserter( wordindex, offset );
+   read_tokens( first, last, options, keywords, inserter );
+
+   offset += static_cast< line_number_type >( count_newlines( first, last ) );
+}
+
+/**
+ * read words from the given stream into the given wordindex; the stream is
+ * read ahead in blocks on a background thread, and the whole lines collected
+ * are tokenized like a mapped file. A block without a newline is tokenized up
+ * to its last non-token character, so that only a partial token is kept.
+ */
+template < typename I >
+void read( std::istream& is, Options const& options, Keywords const& keywords, I& wordindex )
+{
+   logger.Report( 1, "read()\n" );
+
+   BlockReader blocks( is, stream_block_size );
+   CharClasses const classes;
+
+   std::vector< char > block;
+   std::vector< char > buffer;         // the incomplete last line and the next block
+   line_number_type offset = 0;        // lines before buffer
+
+   while ( blocks.next( block ) )
+   {
+      buffer.insert( buffer.end(), block.begin(), block.end() );
+
+      if ( buffer.empty() )
+      {
+         continue;
+      }
+
+      // tokenize up to and including the last complete line; the incomplete
+      // line or partial token kept from before has no newline:
+      char const* const first = &buffer[ 0 ];
+      char const* const fresh = first + buffer.size() - block.size();
+      char const* end = first + buffer.size();
+
+      while ( end != fresh && '\n' != end[ -1 ] )
+      {
+         --end;
+      }
+
+      // no newline: up to the last character that cannot be part of a token:
+      if ( end == fresh )
+      {
+         end = first + buffer.size();
+
+         while ( end != fresh && classes.is( end[ -1 ], CharClasses::token ) )
+         {
+            --end;
+         }
+      }
+
+      if ( end != fresh )
+      {
+         read_lines( first, end, options, keywords, wordindex, offset );
+         buffer.erase( buffer.begin(), buffer.begin() + ( end - first ) );
+      }
+   }
+
+   // the last line need not end in a newline:
+   if ( !buffer.empty() )
+   {
+      read_lines( &buffer[ 0 ], &buffer[ 0 ] + buffer.size(), options, keywords, wordindex, offset );
+   }
+}
+
+/**
+ * read words from the given stream into the wordindex.
+ */
+void read( std::istream& is, Options const& options, Context& context )
+{
+   read( is, options, context.keywords, context.wordindex );
+}
+
+/**
+ * read words from the given character range into the given wordindex.
+ */
+template < typename I >
+void read( char const* first, char const* last, Options const& options, Keywords const& keywords, I& wordindex )
+{
+   logger.Report( 1, "read()\n" );
+
+   read_tokens( first, last, options, keywords, wordindex );
+}
+
+/**
+ * read words from one newline-aligned chunk of input into the chunk's own wordindex;
+ * line numbers are relative to the chunk.
+ */
+template < typename I >
+class ChunkReader
+{
+public:
+   /**
+    * constructor.
+    */
+   ChunkReader( char const* first, char const* last, Options const& options, Keywords const& keywords, I& wordindex )
+   : m_first    ( first )
+   , m_last     ( last )
+   , m_options  ( &options )
+   , m_keywords ( &keywords )
+   , m_wordindex( &wordindex )
+   , m_newlines ( 0 )
+   {
+   }
+
+   /**
+    * read the chunk (thread function).
+    */
+   void operator()()
+   {
+      read( m_first, m_last, *m_options, *m_keywords, *m_wordindex );
+
+      m_newlines = count_newlines( m_first, m_last );
+   }
+
+   /**
+    * number of lines in the chunk.
+    */
+   const long newlines() const
+   {
+      return m_newlines;
+   }
+
+private:
+   char const*     m_first;     ///< begin of chunk
+   char const*     m_last;      ///< end of chunk
+   Options const*  m_options;   ///< the options
+   Keywords const* m_keywords;  ///< the keywords
+   I*              m_wordindex; ///< the chunk's words
+   long            m_newlines;  ///< number of lines in chunk
+};
+
+/**
+ * give an index the counting mode of the index it is added to.
+ */
+inline void set_mode_of( WordIndex const& wordindex, WordIndex& index )
+{
+   index.set_count_only( wordindex.count_only() );
+}
+
+/**
+ * partial indexes always collect line numbers.
+ */
+inline void set_mode_of( PartialIndex const& wordindex, PartialIndex& index )
+{
+}
+
+/**
+ * read words from the given character range into the given wordindex, tokenizing
+ * newline-aligned chunks in parallel; the result equals that of read().
+ */
+template < typename I >
+void read_parallel( char const* first, char const* last, Options const& options, Keywords const& keywords, I& wordindex )
+{
+   logger.Report( 1, "read_parallel()\n" );
+
+   const int chunks = static_cast< int >( std::min< std::size_t >( options.threads, ( last - first ) / min_chunk_size + 1 ) );
+
+   std::vector< char const* > const bounds = split_lines( first, last, chunks );
+
+   /*
+    * tokenize each chunk into its own wordindex:
+    */
+   std::deque< I > indexes( bounds.size() - 1 );
+   std::vector< ChunkReader< I > > readers;
+
+   for ( std::size_t i = 0; i + 1 < bounds.size(); ++i )
+   {
+      set_mode_of( wordindex, indexes[ i ] );
+      readers.push_back( ChunkReader< I >( bounds[ i ], bounds[ i + 1 ], options, keywords, indexes[ i ] ) );
+   }
+
+   run_parallel( readers );
+
+   /*
+    * append chunk results in order, offsetting line numbers by the
+    * number of lines in the preceding chunks (prefix sum):
+    */
+   long offset = 0;
+
+   for ( std::size_t i = 0; i < readers.size(); ++i )
+   {
+      wordindex.append( indexes[ i ], offset );
+      offset += readers[ i ].newlines();
+   }
+}
+
+/**
+ * process a file.
+ */
+template < typename I >
+class basic_reader
+{
+public:
+   /**
+    * the value type.
+    */
+   typedef filename_list_element_type value_type;
+
+   /**
+    * constructor; read into the given wordindex.
+    */
+   basic_reader( Options const& options, Keywords const& keywords, I& wordindex )
+   : m_options  ( options )
+   , m_keywords ( keywords )
+   , m_wordindex( wordindex )
+   {
+   }
+
+   /**
+    * read the given file.
+    */
+   void operator()( value_type const& element )
+   {
+      filename_type const filename( element.first );
+
+      /*
+       * standard input:
+       */
+      if ( "-" == filename )
+      {
+         read( std::cin, m_options, m_keywords, m_wordindex );
+         return;
+      }
+
+      /*
+       * regular file: tokenize the memory-mapped file contents:
+       */
+      if ( is_regular_file( filename ) )
+      {
+         MappedFile file( filename );
+
+         if ( !file.is_open() )
+         {
+            logger.Fatal( "cannot open file '" + filename + "'." );
+         }
+
+         read_range( file.begin(), file.end() );
+         return;
+      }
+
+      /*
+       * pipe or other non-mappable file:
+       */
+      std::ifstream is( to_charptr( filename ) );
+
+      if ( !is )
+      {
+         logger.Fatal( "cannot open file '" + filename + "'." );
+      }
+
+      read( is, m_options, m_keywords, m_wordindex );
+   }
+
+   /**
+    * read the given contents of a regular file, e.g. mapped.
+    */
+   void read_range( char const* first, char const* last )
+   {
+      if ( m_options.parallel && m_options.threads > 1 && static_cast< std::size_t >( last - first ) >= 2 * min_chunk_size )
+      {
+         read_parallel( first, last, m_options, m_keywords, m_wordindex );
+      }
+      else
+      {
+         read( first, last, m_options, m_keywords, m_wordindex );
+      }
+   }
+
+private:
+   /**
+    * the options.
+    */
+   Options const& m_options;
+
+   /**
+    * the keywords.
+    */
+   Keywords const& m_keywords;
+
+   /**
+    * the words read.
+    */
+   I& m_wordindex;
+};
+
+/**
+ * file processor for the wordindex.
+ */
+typedef basic_reader< WordIndex > Reader;
+
+/**
+ * read the given files in order; the small files are loaded a batch at a
+ * time, which also checks that the files exist, other files are read one
+ * by one as they come.
+ */
+void read_files( filename_list_type const& filename_list, Options const& options, Context& context )
+{
+   Reader reader( options, context.keywords, context.wordindex );
+   FileLoader loader;
+
+   logger.Report( 1, std::string( "read_files(): " ) + ( loader.uses_io_uring() ? "io_uring" : "threads" ) + "\n" );
+
+   std::vector< filename_type > filenames;
+   FileLoader::files_type files;
+
+   for ( filename_list_type::const_iterator pos = filename_list.begin(); pos != filename_list.end(); )
+   {
+      filename_list_type::const_iterator const last = pos + std::min< std::size_t >( FileLoader::batch_size, filename_list.end() - pos );
+
+      filenames.clear();
+
+      for ( filename_list_type::const_iterator next = pos; next != last; ++next )
+      {
+         filenames.push_back( next->first );
+      }
+
+      loader.load( filenames, files );
+
+      for ( std::size_t i = 0; pos != last; ++pos, ++i )
+      {
+         if ( "-" == pos->first )
+         {
+            reader( *pos );
+            continue;
+         }
+
+         if ( 0 != files[ i ].error )
+         {
+            cannot_open( *pos );
+         }
+
+         if ( files[ i ].loaded )
+         {
+            read( files[ i ].begin(), files[ i ].end(), options, context.keywords, context.wordindex );
+            continue;
+         }
+
+         // let the system load the next file while this one is read:
+         if ( pos + 1 != filename_list.end() && !( i + 1 < files.size() && files[ i + 1 ].loaded ) )
+         {
+            read_ahead( ( pos + 1 )->first );
+         }
+
+         reader( *pos );
+      }
+   }
+}
+
+/**
+ * note the file that the next words are read from.
+ */
+inline void set_file( PartialIndex& index, int const file )
+{
+   index.set_file( file );
+}
+
+/**
+ * counts do not depend on the file words are read from.
+ */
+inline void set_file( WordIndex& index, int const file )
+{
+}
+
+/**
+ * files were read largest first; order locations by file.
+ */
+inline void finish( PartialIndex& index )
+{
+   index.sort();
+}
+
+/**
+ * counts do not depend on the order files were read in.
+ */
+inline void finish( WordIndex& index )
+{
+}
+
+/**
+ * worker that reads files from the work queues into its own index.
+ */
+template < typename I >
+class basic_file_worker
+{
+public:
+   /**
+    * constructor.
+    */
+   basic_file_worker( int const worker, WorkQueues& queues, filename_list_type const& filename_list, Options const& options, Keywords const& keywords, I& index )
+   : m_worker       ( worker )
+   , m_queues       ( &queues )
+   , m_filename_list( &filename_list )
+   , m_options      ( &options )
+   , m_keywords     ( &keywords )
+   , m_index        ( &index )
+   {
+   }
+
+   /**
+    * read files until no work is left (thread function).
+    */
+   void operator()()
+   {
+      int task = 0;
+
+      while ( m_queues->pop( m_worker, task ) )
+      {
+         set_file( *m_index, task );
+
+         basic_reader< I >( *m_options, *m_keywords, *m_index )( (*m_filename_list)[ task ] );
+      }
+
+      finish( *m_index );
+   }
+
+private:
+   int                       m_worker;        ///< this worker's number
+   WorkQueues*               m_queues;        ///< the per-worker task queues
+   filename_list_type const* m_filename_list; ///< the files to read
+   Options const*            m_options;       ///< the options
+   Keywords const*           m_keywords;      ///< the keywords
+   I*                        m_index;         ///< this worker's words
+};
+
+/**
+ * run a worker per index to read the given files, largest files first.
+ */
+template < typename I >
+void read_files_into( filename_list_type const& filename_list, Options const& options, Keywords const& keywords, std::deque< I >& indexes )
+{
+   /*
+    * schedule files by size, largest first:
+    */
+   std::vector< file_size_type > sizes;
+
+   for ( filename_list_type::const_iterator pos = filename_list.begin(); pos != filename_list.end(); ++pos )
+   {
+      sizes.push_back( file_size( pos->first ) );
+   }
+
+   const int jobs = static_cast< int >( indexes.size() );
+
+   WorkQueues queues( jobs );
+   schedule_largest_first( queues, sizes );
+
+   /*
+    * each worker reads its files into its own index; a file is not split in chunks:
+    */
+   Options file_options( options );
+   file_options.parallel = false;
+
+   std::vector< basic_file_worker< I > > workers;
+
+   for ( int i = 0; i < jobs; ++i )
+   {
+      workers.push_back( basic_file_worker< I >( i, queues, filename_list, file_options, keywords, indexes[ i ] ) );
+   }
+
+   run_parallel( workers );
+}
+
+/**
+ * read the given files with options.jobs worker threads, largest files first,
+ * and merge the workers' indexes; the result equals that of reading the files
+ * one after another.
+ */
+void read_files_parallel( filename_list_type const& filename_list, Options const& options, Context& context )
+{
+   logger.Report( 1, "read_files_parallel()\n" );
+
+   const int jobs = static_cast< int >( std::min< std::size_t >( options.jobs, filename_list.size() ) );
+
+   /*
+    * counts only need adding up:
+    */
+   if ( context.wordindex.count_only() )
+   {
+      std::deque< WordIndex > indexes( jobs );
+
+      for ( int i = 0; i < jobs; ++i )
+      {
+         indexes[ i ].set_count_only();
+      }
+
+      read_files_into( filename_list, options, context.keywords, indexes );
+
+      for ( int i = 0; i < jobs; ++i )
+      {
+         context.wordindex.splice( indexes[ i ] );
+      }
+      return;
+   }
+
+   std::deque< PartialIndex > indexes( jobs );
+
+   read_files_into( filename_list, options, context.keywords, indexes );
+
+   /*
+    * merge the partial indexes in (file, line) order:
+    */
+   std::vector< PartialIndex const* > parts;
+
+   for ( std::size_t i = 0; i < indexes.size(); ++i )
+   {
+      parts.push_back( &indexes[ i ] );
+   }
+
+   merge_parallel( parts, context.wordindex, jobs );
+}
+
+/**
+ * function object to print an entry from the colleced words.
+ */
+class Printer
+{
+public:
+   /**
+    * constructor; frequencies are relative to the given number of references.
+    */
+   Printer( OutputBuffer& out, Options const& options, WordIndex::count_type const references )
+   : m_out( out )
+   , m_options( options )
+   , m_references( references )
+   {
+      ; // do nothing
+   }
+
+   /**
+    * print the given entry, of a word index or an index file.
+    */
+   template < typename V >
+   void operator()( V const& value ) const
+   {
+      const WordIndex::count_type count = value.count;
+      const double perct = 100.0 * count / m_references;
+
+      m_out.write( value.first.begin(), value.first.end(), m_options.name_width );
+      m_out.write( "  " );
+
+      if ( m_options.frequency )
+      {
+         m_out.write_fixed( perct, 3, 3 );
+         m_out.write( "% (" );
+         m_out.write_integer( count, 6 );
+         m_out.write( ")  " );
+      }
+
+      for ( Postings::const_iterator pos = value.second.begin(); pos != value.second.end(); ++pos )
+      {
+         m_out.write_integer( *pos );
+         m_out.write( "  " );
+      }
+
+      m_out.put( '\n' );
+   }
+
+private:
+   /**
+    * the output buffer.
+    */
+   OutputBuffer& m_out;
+
+   /**
+    * the options.
+    */
+
+   Options const& m_options;
+
+   /**
+    * the total number of references.
+    */
+   WordIndex::count_type m_references;
+};
+
+/**
+ * estimated output size at which the parallel printer starts a new range.
+ */
+const std::size_t print_range_size = 1 << 22;
+
+/**
+ * format a range of the words of an index into a buffer (thread function).
+ */
+template < typename I >
+class RangePrinter
+{
+public:
+   /**
+    * the iterator type.
+    */
+   typedef typename I::const_iterator const_iterator;
+
+   /**
+    * constructor.
+    */
+   RangePrinter( const_iterator first, const_iterator last, Options const& options, I const& index, OutputBuffer& out )
+   : m_first  ( first )
+   , m_last   ( last )
+   , m_options( &options )
+   , m_index  ( &index )
+   , m_out    ( &out )
+   {
+   }
+
+   /**
+    * format the range.
+    */
+   void operator()()
+   {
+      std::for_each( m_first, m_last, Printer( *m_out, *m_options, m_index->lines() ) );
+   }
+
+private:
+   const_iterator m_first;   ///< first word of range
+   const_iterator m_last;    ///< end of range
+   Options const* m_options; ///< the options
+   I const*       m_index;   ///< the index
+   OutputBuffer*  m_out;     ///< the range's output
+};
+
+/**
+ * estimated number of characters printed for the given entry.
+ */
+template < typename V >
+inline const std::size_t print_size( V const& value, Options const& options )
+{
+   return std::max< std::size_t >( options.name_width, value.first.size() ) + 3 + ( options.frequency ? 20 : 0 ) + 8 * value.second.size();
+}
+
+/**
+ * print the words of an index, formatting them on options.threads threads:
+ * cut the sorted words into ranges of about print_range_size characters,
+ * format a round of ranges concurrently, each into its own buffer, and write
+ * the buffers in order; standard output is written with writev().
+ */
+template < typename I >
+void print_parallel( std::ostream& os, Options const& options, I const& index )
+{
+   logger.Report( 1, "print_parallel()\n" );
+
+   typedef typename I::const_iterator const_iterator;
+
+   std::deque< OutputBuffer > buffers( options.threads );
+   std::vector< RangePrinter< I > > printers;
+
+   const_iterator       pos = index.begin();
+   const_iterator const end = index.end();
+
+   while ( pos != end )
+   {
+      printers.clear();
+
+      for ( int i = 0; i < options.threads && pos != end; ++i )
+      {
+         const_iterator const first = pos;
+
+         for ( std::size_t size = 0; pos != end && size < print_range_size; ++pos )
+         {
+            size += print_size( *pos, options );
+         }
+
+         buffers[ i ].clear();
+         printers.push_back( RangePrinter< I >( first, pos, options, index, buffers[ i ] ) );
+      }
+
+      for ( std::size_t i = printers.size(); i < buffers.size(); ++i )
+      {
+         buffers[ i ].clear();
+      }
+
+      if ( 1 == printers.size() )
+      {
+         printers[ 0 ]();
+      }
+      else
+      {
+         run_parallel( printers );
+      }
+
+#ifndef _WIN32
+      if ( &os == &std::cout )
+      {
+         std::cout.flush();
+
+         if ( !write_buffers( STDOUT_FILENO, buffers ) )
+         {
+            logger.Fatal( "cannot write to standard output." );
+         }
+         continue;
+      }
+#endif
+      write_buffers( os, buffers );
+   }
+}
+
+/**
+ * print the words of an index with the given numbers (positions in word order).
+ */
+template < typename I >
+void print_numbers( Printer const& printer, I const& index, WordTrie::range_type const& range )
+{
+   typename I::const_iterator pos = index.begin();
+   pos += range.first;
+
+   for ( WordTrie::size_type n = range.first; n < range.second; ++n, ++pos )
+   {
+      printer( *pos );
+   }
+}
+
+/**
+ * the trie kept with a word index: none, it is made when needed.
+ */
+WordTrie const* stored_trie( WordIndex const& index )
+{
+   return NULL;
+}
+
+/**
+ * the trie kept with an index file.
+ */
+WordTrie const* stored_trie( IndexFile const& index )
+{
+   return &index.trie();
+}
+
+/**
+ * print the words of an index that are asked for, in the order asked; words
+ * not present are skipped. Each word is looked up, see find() of the index;
+ * a pattern with wildcards '*' and '?' is matched against all words through
+ * a trie, that of an index file or else made from the sorted words once
+ * needed; a prefix, like 'foo*', selects a range of words.
+ */
+template < typename I >
+void print_queries( OutputBuffer& out, Options const& options, I const& index )
+{
+   Printer const printer( out, options, index.lines() );
+
+   WordTrie const* trie = stored_trie( index );
+   WordTrie made;
+   WordTrie::numbers_type numbers;
+
+   for ( std::vector< std::string >::const_iterator word = options.queries.begin(); word != options.queries.end(); ++word )
+   {
+      if ( WordTrie::is_pattern( *word ) )
+      {
+         if ( NULL == trie )
+         {
+            made.assign( index.begin(), index.end() );
+            trie = &made;
+
+            logger.Report( 1, "print_queries(): trie of " + to_string( static_cast< long >( trie->nodes() ) ) + " nodes in " + to_string( static_cast< long >( trie->size_in_bytes() ) ) + " bytes\n" );
+         }
+
+         std::string::size_type const wildcard = word->find_first_of( "*?" );
+
+         if ( wildcard + 1 == word->size() && '*' == (*word)[ wildcard ] )
+         {
+            print_numbers( printer, index, trie->prefix_range( word->substr( 0, wildcard ) ) );
+            continue;
+         }
+
+         trie->match( *word, numbers );
+
+         for ( WordTrie::numbers_type::const_iterator n = numbers.begin(); n != numbers.end(); ++n )
+         {
+            print_numbers( printer, index, WordTrie::range_type( *n, *n + 1 ) );
+         }
+         continue;
+      }
+
+      typename I::const_iterator const pos = index.find( *word );
+
+      if ( pos != index.end() )
+      {
+         printer( *pos );
+      }
+      else
+      {
+         logger.Report( 1, "print_queries(): '" + *word + "' not present\n" );
+      }
+   }
+}
+
+/**
+ * print the words of a word index or an index file, made with the given
+ * number of keywords; only the words asked for, if any.
+ */
+template < typename I >
+void print_index( std::ostream& os, Options const& options, std::size_t const keywords, I const& index )
+{
+   OutputBuffer out( os );
+
+   if ( options.summary )
+   {
+      out.write(   "keywords", options.name_width ); out.write( "  " ); out.write_integer( keywords        ); out.put( '\n' );
+      out.write(      "words", options.name_width ); out.write( "  " ); out.write_integer( index.words() ); out.put( '\n' );
+      out.write( "references", options.name_width ); out.write( "  " ); out.write_integer( index.lines() ); out.put( '\n' );
+      out.put( '\n' );
+   }
+
+   if ( options.query )
+   {
+      print_queries( out, options, index );
+      return;
+   }
+
+   if ( ( options.parallel || options.jobs > 1 ) && options.threads > 1 )
+   {
+      out.flush();
+      print_parallel( os, options, index );
+      return;
+   }
+
+   std::for_each
+   ( index.begin()
+   , index.end()
+   , Printer( out, options, index.lines() )
+   );
+}
+
+/**
+ * the distinct locations of words in an index file; the locations of a word
+ * are decoded once and kept for later queries.
+ */
+class IndexFileLookup
+{
+public:
+   /**
+    * constructor.
+    */
+   IndexFileLookup( IndexFile const& index )
+   : m_index( &index )
+   {
+   }
+
+   /**
+    * the locations of the given word.
+    */
+   locations_type const& operator()( std::string const& word )
+   {
+      std::map< std::string, locations_type >::iterator pos = m_cache.find( word );
+
+      if ( pos == m_cache.end() )
+      {
+         pos = m_cache.insert( std::make_pair( word, locations_type() ) ).first;
+
+         m_index->locations( word, pos->second );
+
+         // a word may occur more than once on a line:
+         pos->second.erase( std::unique( pos->second.begin(), pos->second.end() ), pos->second.end() );
+      }
+      return pos->second;
+   }
+
+private:
+   IndexFile const* m_index;   ///< the index
+   std::map< std::string, locations_type > m_cache;  ///< the words looked up
+};
+
+/**
+ * the distinct locations of the words of queries, collected file by file while reading.
+ */
+class TermLookup
+{
+public:
+   /**
+    * the word--locations map type.
+    */
+   typedef std::map< std::string, locations_type > terms_type;
+
+   /**
+    * constructor; collect the locations of the words of the given queries.
+    */
+   TermLookup( std::vector< BooleanQuery > const& queries )
+   {
+      for ( std::vector< BooleanQuery >::const_iterator query = queries.begin(); query != queries.end(); ++query )
+      {
+         BooleanQuery::words_type const words = query->words();
+
+         for ( BooleanQuery::words_type::const_iterator word = words.begin(); word != words.end(); ++word )
+         {
+            m_terms[ *word ];
+         }
+      }
+   }
+
+   /**
+    * add the locations of the words in the given index, read from the given file.
+    */
+   void add( std::size_t const file, WordIndex const& index )
+   {
+      for ( terms_type::iterator term = m_terms.begin(); term != m_terms.end(); ++term )
+      {
+         WordIndex::const_iterator const pos = index.find( term->first );
+
+         if ( pos == index.end() )
+         {
+            continue;
+         }
+
+         locations_type& locations = term->second;
+
+         for ( Postings::const_iterator line = pos->second.begin(); line != pos->second.end(); ++line )
+         {
+            location_type const here = location( file, *line );
+
+            // a word may occur more than once on a line:
+            if ( locations.empty() || locations.back() != here )
+            {
+               locations.push_back( here );
+            }
+         }
+      }
+   }
+
+   /**
+    * the locations of the given word.
+    */
+   locations_type const& operator()( std::string const& word )
+   {
+      return m_terms[ word ];
+   }
+
+private:
+   terms_type m_terms;   ///< the words with their locations
+};
+
+/**
+ * print the line numbers that satisfy each boolean query, labelled with the
+ * query, in the order of the files and lines they refer to; the percentage
+ * of option --frequency is of the given number of references.
+ */
+template < typename L >
+void print_matches( std::ostream& os, Options const& options, WordIndex::count_type const references, L& lookup )
+{
+   OutputBuffer out( os );
+   Printer const printer( out, options, references );
+
+   locations_type found;
+
+   for ( std::vector< BooleanQuery >::const_iterator query = options.matches.begin(); query != options.matches.end(); ++query )
+   {
+      query->evaluate( lookup, found );
+
+      Postings lines;
+
+      for ( locations_type::const_iterator pos = found.begin(); pos != found.end(); ++pos )
+      {
+         lines.push_back( line_of( *pos ) );
+      }
+
+      std::string const& expression = query->expression();
+
+      printer( WordIndex::value_type( WordIndex::word_type( expression.data(), expression.data() + expression.size() ), lines, found.size() ) );
+   }
+}
+
+/**
+ * read the given files, one at a time, and print the lines that satisfy the
+ * boolean queries; only the locations of the words of the queries are kept.
+ */
+void read_matches( std::ostream& os, filename_list_type const& filename_list, Options const& options, Context const& context )
+{
+   logger.Report( 1, "read_matches()\n" );
+
+   TermLookup lookup( options.matches );
+
+   WordIndex wordindex;
+   Reader reader( options, context.keywords, wordindex );
+
+   WordIndex::count_type references = 0;
+
+   for ( std::size_t file = 0; file < filename_list.size(); ++file )
+   {
+      check_file_exists( filename_list[ file ] );
+
+      wordindex.clear();
+      reader( filename_list[ file ] );
+
+      lookup.add( file, wordindex );
+      references += wordindex.lines();
+   }
+
+   print_matches( os, options, references, lookup );
+}
+
+/**
+ * print the collected words.
+ */
+void print( std::ostream& os, Options const& options, Context const& context )
+{
+   logger.Report( 1, "print()\n" );
+
+   logger.Report( 1, "postings: " + to_string( static_cast< long >( context.wordindex.postings_size() ) ) + " bytes for " + to_string( static_cast< long >( context.wordindex.lines() ) ) + " references\n" );
+
+   /*
+    * report wordindex contents:
+    */
+   print_index( os, options, context.keywords.size(), context.wordindex );
+}
+
+/**
+ * print the words of the given index file.
+ */
+void print_saved_index( std::ostream& os, Options const& options, filename_type const& filename )
+{
+   logger.Report( 1, "print_saved_index()\n" );
+
+   IndexFile const index( filename );
+
+   if ( !index.is_open() )
+   {
+      logger.Fatal( "index file '" + filename + "' cannot be opened, is damaged or was written by another version or machine." );
+   }
+
+   if ( options.match )
+   {
+      if ( index.count_only() )
+      {
+         logger.Fatal( "index file '" + filename + "' only counts words; option --match needs line numbers." );
+      }
+
+      IndexFileLookup lookup( index );
+
+      print_matches( os, options, index.lines(), lookup );
+      return;
+   }
+
+   print_index( os, options, index.keywords(), index );
+}
+
+/**
+ * the signature of the options that determine the words of an index: an index
+ * file can only be updated with the same options and keywords.
+ */
+const IndexFile::offset_type index_signature( Options const& options, Keywords const& keywords )
+{
+   std::vector< std::string > words;
+   keywords.copy_to( words );
+
+   std::sort( words.begin(), words.end() );
+   words.erase( std::unique( words.begin(), words.end() ), words.end() );
+
+   hash_type hash = hash_basis;
+
+   hash = hash_add( hash, options.count     ? 'c' : '-' );
+   hash = hash_add( hash, options.lowercase ? 'l' : '-' );
+   hash = hash_add( hash, options.reverse   ? 'r' : '-' );
+
+   for ( std::vector< std::string >::const_iterator pos = words.begin(); pos != words.end(); ++pos )
+   {
+      hash = hash_add( hash, '\n' );
+
+      for ( std::string::const_iterator chr = pos->begin(); chr != pos->end(); ++chr )
+      {
+         hash = hash_add( hash, *chr );
+      }
+   }
+   return hash;
+}
+
+/**
+ * true if the size and modification time of the given file tell that it is
+ * as recorded in an index file started at the given time, without reading
+ * it. A file modified again in the clock tick it was read in may still carry
+ * the recorded time, hence the time must precede the start.
+ */
+const bool is_unchanged( IndexedFile const& earlier, IndexedFile const& file, file_time_type const started )
+{
+   return is_regular_file( file.name ) && file.size == earlier.size && file.time == earlier.time && file.time < started;
+}
+
+/**
+ * rename the given file to the other name, replacing a file of that name at
+ * once where the system allows; true if done.
+ */
+const bool replace_file( filename_type const& from, filename_type const& to )
+{
+#ifdef _WIN32
+   // rename() does not replace an existing file here:
+   if ( exist( to ) && 0 != std::remove( to_charptr( to ) ) )
+   {
+      return false;
+   }
+#endif
+   return 0 == std::rename( to_charptr( from ), to_charptr( to ) );
+}
+
+/**
+ * read the given files and save their words as index file. If the index file
+ * exists and was made with the same options, the words of the files that are
+ * unchanged since are taken from it and only the other files are read; the
+ * words of files no longer given are left out.
+ */
+void save_index( filename_type const& filename, filename_list_type const& filename_list, Options const& options, Context const& context )
+{
+   logger.Report( 1, "save_index()\n" );
+
+   IndexBuilder builder( options.count, context.keywords.size(), index_signature( options, context.keywords ) );
+
+   /*
+    * the earlier index, if usable:
+    */
+   IndexFile* earlier = NULL;
+
+   if ( exist( filename ) )
+   {
+      if ( !IndexFile::is_index_file( filename ) )
+      {
+         logger.Fatal( "file '" + filename + "' exists and is not an index file." );
+      }
+
+      earlier = new IndexFile( filename );
+
+      if ( !earlier->is_open() || earlier->signature() != index_signature( options, context.keywords ) )
+      {
+         logger.Report( 1, "save_index(): index made with other options or version, rebuilding\n" );
+
+         delete earlier;
+         earlier = NULL;
+      }
+   }
+
+   /*
+    * write aside, to replace the earlier index once complete; the index is
+    * started at the time the system gives the file written aside:
+    */
+   filename_type const temporary( filename + ".tmp" );
+
+   std::ofstream os( to_charptr( temporary ), std::ios::binary );
+
+   if ( !os )
+   {
+      logger.Fatal( "cannot write file '" + temporary + "'." );
+   }
+
+   builder.set_started( file_time( temporary ) );
+
+   std::map< filename_type, IndexBuilder::size_type > earlier_files;
+   std::vector< IndexBuilder::size_type > numbers;
+
+   if ( earlier )
+   {
+      for ( IndexBuilder::size_type i = 0; i < earlier->files().size(); ++i )
+      {
+         earlier_files.insert( std::make_pair( earlier->files()[ i ].name, i ) );
+      }
+
+      // a copy: the in-class constant has no definition to bind a reference to
+      IndexBuilder::size_type const unused = IndexBuilder::npos;
+
+      numbers.assign( earlier->files().size(), unused );
+   }
+
+   /*
+    * read the files that are new or changed, each into a word index of its own:
+    */
+   WordIndex wordindex;
+   wordindex.set_count_only( options.count );
+
+   Reader reader( options, context.keywords, wordindex );
+
+   std::size_t reused = 0;
+
+   for ( filename_list_type::const_iterator pos = filename_list.begin(); pos != filename_list.end(); ++pos )
+   {
+      check_file_exists( *pos );
+
+      IndexedFile file( pos->first );
+
+      std::map< filename_type, IndexBuilder::size_type >::iterator const found = earlier_files.find( file.name );
+
+      IndexedFile const* const recorded = found != earlier_files.end() ? &earlier->files()[ found->second ] : NULL;
+
+      bool unchanged = recorded && is_unchanged( *recorded, file, earlier->started() );
+
+      wordindex.clear();
+
+      if ( !unchanged && is_regular_file( file.name ) )
+      {
+         // mapped once, to compare the contents and to read them if changed:
+         MappedFile const contents( file.name );
+
+         if ( !contents.is_open() )
+         {
+            logger.Fatal( "cannot open file '" + file.name + "'." );
+         }
+
+         file.hash = hash_bytes( contents.begin(), contents.end() );
+
+         unchanged = recorded && file.size == recorded->size && file.hash == recorded->hash;
+
+         if ( !unchanged )
+         {
+            reader.read_range( contents.begin(), contents.end() );
+         }
+      }
+      else if ( !unchanged )
       {
-         logger.Fatal( "cannot open file '" + filename + "'." );
+         reader( *pos );
+      }
+
+      if ( unchanged )
+      {
+         file.hash = recorded->hash;
+
+         numbers[ found->second ] = builder.add_file( file );
+         earlier_files.erase( found );
+         ++reused;
       }
       else
       {
-         logger.Fatal( "filename list, line " + to_string( linenumber ) + ": cannot open file '" + filename + "'." );
+         builder.add( builder.add_file( file ), wordindex );
       }
    }
-}
-
-/**
- * value contained in collection predicate.
- */
-template < typename C >
-class contained_in : public std::unary_function< typename C::value_type, bool >
-{
-public:
-   /**
-    * the set type.
-    */
-   typedef C container_type;
 
-   /**
-    * the value type.
-    */
-   typedef typename container_type::value_type value_type;
+   logger.Report( 1, "save_index(): " + to_string( static_cast< long >( reused ) ) + " of " + to_string( static_cast< long >( filename_list.size() ) ) + " files unchanged\n" );
 
-   /**
-    * the value type.
-    */
-   contained_in( container_type const& c )
-   : m_container( c )
+   if ( earlier )
    {
-      ;
+      builder.add( *earlier, numbers );
+
+      delete earlier;
    }
 
-   /**
-    * the value type.
-    */
-   bool operator()( value_type const& value ) const
+   builder.write( os );
+   os.close();
+
+   if ( !os || !replace_file( temporary, filename ) )
    {
-      return m_container.count( value ) > 0;
+      logger.Fatal( "cannot write file '" + filename + "'." );
    }
-
-private:
-   /**
-    * the set.
-    */
-   container_type const& m_container;
-};
+}
 
 /**
- * read words from the given stream into the wordindex.
+ * read keywords from the given stream into the given keyword collection.
  */
-void read( std::istream& is, Options const& options, Context& context )
+template < typename C >
+void read_keywords( std::istream& is, C& keywords )
 {
-   logger.Report( 1, "read()\n" );
-
-   /*
-    * read input tokens, add token-linenumber pairs to wordindex:
-    */
    Tokenizer tokenizer( is );
-   //   tokenizer.lines_per_page( opt_lines_per_page );
-   tokenizer.set_lowercase( options.lowercase );
+   tokenizer.set_skip_comments();
 
-   if ( options.reverse ) // include only keywords
-   {
-      std::remove_copy_if
-      ( tokenizer.begin(), tokenizer.end()
-      , wordindex_inserter( context.wordindex )
-      , std::not1( contained_in< Keywords >( context.keywords ) )
-      );
-   }
-   else // include only non-keywords
+   for ( Tokenizer::iterator pos = tokenizer.begin(); pos != tokenizer.end(); ++pos )
    {
-      std::remove_copy_if
-      ( tokenizer.begin(), tokenizer.end()
-      , wordindex_inserter( context.wordindex )
-      , contained_in< Keywords >( context.keywords )
-      );
+      keywords.insert( (*pos).first );
    }
 }
 
 /**
- * process a file.
+ * read words to look up from the given stream; they are tokenized as the
+ * text is, so that they are found as read, except that they may contain
+ * wildcards.
  */
-class Reader
+void read_queries( std::istream& is, Options& options )
 {
-public:
-   /**
-    * the value type.
-    */
-   typedef filename_list_element_type value_type;
+   Tokenizer tokenizer( is );
+   tokenizer.set_lowercase( options.lowercase );
+   tokenizer.set_skip_comments();
+   tokenizer.add_to_start_set( "*?" );
+   tokenizer.add_to_followset( "*?" );
 
-   /**
-    * constructor.
-    */
-   Reader( Options const& options, Context& context )
-   : m_options( options )
-   , m_context( context )
+   for ( Tokenizer::iterator pos = tokenizer.begin(); pos != tokenizer.end(); ++pos )
    {
+      options.queries.push_back( (*pos).first );
    }
+}
 
-   /**
-    * read the given file.
-    */
-   void operator()( value_type const& element )
-   {
-      filename_type const filename( element.first );
-
-      std::ifstream is( to_charptr( filename ) );
-
-      if ( !is )
-      {
-         logger.Fatal( "cannot open file '" + filename + "'." );
-      }
+/**
+ * compile the given boolean query and add it to the queries to print the lines of.
+ */
+void add_match( std::string const& expression, Options& options )
+{
+   BooleanQuery const query( expression, options.lowercase );
 
-      read( is, m_options, m_context );
+   if ( !query.is_valid() )
+   {
+      logger.Fatal( "query '" + expression + "': " + query.error() + "." );
    }
 
-private:
-   /**
-    * the options.
-    */
-   Options const& m_options;
-
-   /**
-    * the context (words and keywords).
-    */
-   Context& m_context;
-};
+   options.matches.push_back( query );
+}
 
 /**
- * function object to print an entry from the colleced words.
+ * build the perfect-hash table of the keywords in the given (text) file
+ * for the given option.
  */
-class Printer
+void build_keywords( std::string const& option, filename_type const& keywords, StopwordTableBuilder& builder )
 {
-   /**
-    * the value type.
-    */
-   typedef WordIndex::value_type value_type;
-
-public:
-   /**
-    * constructor.
-    */
-   Printer( std::ostream& os, Options const& options, Context const& context )
-   : m_os( os )
-   , m_options( options )
-   , m_context( context )
+   if ( keywords.empty() )
    {
-      ; // do nothing
+      logger.Fatal( "option --" + option + " expects option --keywords.\n" + try_help );
    }
 
-   /**
-    * print the given entry.
-    */
-   void operator()( value_type const& value ) const
+   if ( StopwordFile::is_stopword_file( keywords ) )
    {
-      const int    count = value.second.size();
-      const double perct = 100.0 * value.second.size() / m_context.wordindex.lines();
+      logger.Fatal( "keyword file '" + keywords + "' is already compiled." );
+   }
 
-      m_os <<
-         std::setw(m_options.name_width) << std::right << value.first << "  ";
+   std::ifstream is( to_charptr( keywords ) );
 
-      if ( m_options.frequency )
-      {
-         m_os <<
-            std::fixed << std::setw(3) << std::setprecision(3) << perct << "%" << " (" << std::setw(6) << count << ")  ";
-      }
-      print_collection( m_os, value.second );
+   if ( !is )
+   {
+      logger.Fatal( "cannot open file '" + keywords + "'." );
+   }
 
-      m_os << std::endl;
+   read_keywords( is, builder );
+
+   if ( !builder.build() )
+   {
+      logger.Fatal( "cannot create a perfect-hash table for the keywords in '" + keywords + "'." );
    }
+}
 
-private:
-   /**
-    * the output stream.
-    */
-   std::ostream& m_os;
+/**
+ * write the keywords of the given file as header that defines them as
+ * perfect-hash table, see src/Stopwords.h.
+ */
+void make_keywords( filename_type const& keywords, filename_type const& header )
+{
+   logger.Report( 1, "make_keywords()\n" );
 
-   /**
-    * the options.
-    */
+   StopwordTableBuilder builder;
+   build_keywords( "make-keywords", keywords, builder );
 
-   Options const& m_options;
+   std::ofstream os( to_charptr( header ) );
 
-   /**
-    * the context (words and keywords).
-    */
-   Context const& m_context;
-};
+   builder.write_header( os, keywords );
+
+   if ( !os )
+   {
+      logger.Fatal( "cannot write file '" + header + "'." );
+   }
+}
 
 /**
- * print the collected words.
+ * write the keywords of the given file as precompiled keyword file,
+ * which option --keywords accepts as well.
  */
-void print( std::ostream& os, Options const& options, Context const& context )
+void compile_keywords( filename_type const& keywords, filename_type const& compiled )
 {
-   logger.Report( 1, "print()\n" );
+   logger.Report( 1, "compile_keywords()\n" );
 
-   /*
-    * report wordindex contents:
-    */
-   if ( options.summary )
+   StopwordTableBuilder builder;
+   build_keywords( "compile-keywords", keywords, builder );
+
+   std::ofstream os( to_charptr( compiled ), std::ios::binary );
+
+   StopwordFile::write( os, builder.table() );
+
+   if ( !os )
    {
-      os <<
-         std::setw( options.name_width ) <<   "keywords" << "  " << context.keywords.size() << std::endl <<
-         std::setw( options.name_width ) <<      "words" << "  " << context.wordindex.words() << std::endl <<
-         std::setw( options.name_width ) << "references" << "  " << context.wordindex.lines() << std::endl << std::endl;
+      logger.Fatal( "cannot write file '" + compiled + "'." );
    }
-
-   std::for_each
-   ( context.wordindex.begin()
-   , context.wordindex.end()
-   , Printer( os, options, context )
-   );
 }
 
 /**
@@ -706,15 +2012,27 @@ int main( int argc, char* argv[] )
            SwitchArg clpAuthor    ( "a", "author"         , "", cmd, false, new AuthorVisitor( &std::cout, author_string ) );
       MultiSwitchArg clpVerbose   ( "v", "verbose"        , "", cmd, false );
 
+           SwitchArg clpCount     ( "c", "count"          , "", cmd, false );
            SwitchArg clpFrequency ( "f", "frequency"      , "", cmd, false );
 //           SwitchArg clpIgnorecase( "g", "ignorecase"     , "", cmd, false );
            SwitchArg clpLowercase ( "l", "lowercase"      , "", cmd, false );
+           SwitchArg clpParallel  ( "p", "parallel"       , "", cmd, false );
            SwitchArg clpReverse   ( "r", "reverse"        , "", cmd, false );
            SwitchArg clpSummary   ( "s", "summary"        , "", cmd, false );
 
+              IntArg clpJobs      ( "j", "jobs"           , "number of files to read at a time", false, 1, "n", cmd );
            StringArg clpInput     ( "i", "input"          , "file with filenames", false, "[none]", "filename", cmd );
            StringArg clpOutput    ( "o", "output"         , "outut file", false, "standard output", "filename", cmd );
            StringArg clpKeywords  ( "k", "keywords"       , "keyword file", false, "[none]", "filename", cmd );
+           SwitchArg clpBuiltin   ( "b", "builtin-keywords", "", cmd, false );
+           StringArg clpMakeKeywords( "", "make-keywords" , "header file", false, "[none]", "filename", cmd );
+           StringArg clpCompileKeywords( "", "compile-keywords", "precompiled keyword file", false, "[none]", "filename", cmd );
+           StringArg clpSaveIndex ( "", "save-index"     , "index file", false, "[none]", "filename", cmd );
+           StringArg clpLoadIndex ( "", "load-index"     , "index file", false, "[none]", "filename", cmd );
+           StringArg clpQuery     ( "q", "query"          , "words to print", false, "[none]", "words", cmd );
+           StringArg clpQueries   ( "", "queries"        , "file with words to print", false, "[none]", "filename", cmd );
+           StringArg clpMatch     ( "m", "match"          , "boolean query", false, "[none]", "query", cmd );
+           StringArg clpMatches   ( "", "matches"        , "file with boolean queries", false, "[none]", "filename", cmd );
 
 //            FileArgs fileArgs    (  "", "filenames"      , false, "type-descr.", cmd, false );
             FileArgs fileArgs    (  "", "filenames"      , false, new FilenameConstraint( logger ), cmd );
@@ -741,12 +2059,102 @@ int main( int argc, char* argv[] )
       /*
        * flags:
        */
+      options.count      = clpCount.isSet();
       options.frequency  = clpFrequency.isSet();
 //      options.ignorecase = clpIgnorecase.isSet();
       options.lowercase  = clpLowercase.isSet();
+      options.parallel   = clpParallel.isSet();
+
+      if ( clpJobs.isSet() )
+      {
+         if ( clpJobs.getValue() < 1 )
+         {
+            logger.Fatal( "option --jobs expects a positive number.\n" + try_help );
+         }
+         options.jobs    = clpJobs.getValue();
+         options.threads = clpJobs.getValue();
+      }
       options.reverse    = clpReverse.isSet();
       options.summary    = clpSummary.isSet();
 
+      /*
+       * words to print, if not all:
+       */
+      options.query = clpQuery.isSet() || clpQueries.isSet();
+
+      if ( clpQuery.isSet() )
+      {
+         // the tokenizer needs a separator to end the last word:
+         std::istringstream is( clpQuery.getValue() + "\n" );
+         read_queries( is, options );
+      }
+
+      if ( clpQueries.isSet() )
+      {
+         const filename_type filename( clpQueries.getValue() );
+
+         std::ifstream is( to_charptr( filename ) );
+
+         if ( !is )
+         {
+            logger.Fatal( "cannot open file '" + filename + "' to read words to print from." );
+         }
+
+         read_queries( is, options );
+      }
+
+      /*
+       * boolean queries to print the lines of, if any; one per line of a file:
+       */
+      options.match = clpMatch.isSet() || clpMatches.isSet();
+
+      if ( clpMatch.isSet() )
+      {
+         add_match( clpMatch.getValue(), options );
+      }
+
+      if ( clpMatches.isSet() )
+      {
+         const filename_type filename( clpMatches.getValue() );
+
+         std::ifstream is( to_charptr( filename ) );
+
+         if ( !is )
+         {
+            logger.Fatal( "cannot open file '" + filename + "' to read boolean queries from." );
+         }
+
+         std::string line;
+
+         while ( std::getline( is, line ) )
+         {
+            // skip empty lines and comment lines:
+            std::string::size_type const first = line.find_first_not_of( " \t\r" );
+
+            if ( std::string::npos != first && '#' != line[ first ] )
+            {
+               add_match( line, options );
+            }
+         }
+      }
+
+      if ( ( options.query || options.match ) && clpSaveIndex.isSet() )
+      {
+         logger.Fatal( "options --query and --match print words, but --save-index prints none.\n" + try_help );
+      }
+
+      if ( options.query && options.match )
+      {
+         logger.Fatal( "options --query and --match cannot be combined.\n" + try_help );
+      }
+
+      if ( options.match && options.count )
+      {
+         logger.Fatal( "option --match needs line numbers, but --count only counts words.\n" + try_help );
+      }
+
+      context.wordindex.set_count_only( options.count );
+
 //      if ( options.ignorecase )
 //      {
 //         logger.Fatal( "option --ignorecase is not yet implemented." );
@@ -757,7 +2165,7 @@ int main( int argc, char* argv[] )
        */
       if ( clpOutput.isSet() )
       {
-         const filename_type filename( clpKeywords.getValue() );
+         const filename_type filename( clpOutput.getValue() );
 
          output = new std::ofstream( to_charptr( filename ) );
 
@@ -768,28 +2176,97 @@ int main( int argc, char* argv[] )
       }
 
       /*
-       * read keywords if requested:
+       * print a saved index if requested; it was made from text read before:
        */
-      if ( clpKeywords.isSet() )
+      if ( clpLoadIndex.isSet() )
       {
-         const filename_type filename( clpKeywords.getValue() );
+         if ( !fileArgs.getValue().empty() || clpInput.isSet() || clpSaveIndex.isSet() )
+         {
+            logger.Fatal( "option --load-index reads no input files and saves no index.\n" + try_help );
+         }
 
-         std::ifstream is( to_charptr( filename ) );
+         // these determine the words of the index, which are as saved:
+         if ( clpKeywords.isSet() || clpBuiltin.isSet() || clpReverse.isSet() || clpLowercase.isSet() || clpCount.isSet() )
+         {
+            logger.Fatal( "options --keywords, --builtin-keywords, --reverse, --lowercase and --count apply to --save-index, not to --load-index.\n" + try_help );
+         }
 
-         if ( !is )
+         print_saved_index( *output, options, clpLoadIndex.getValue() );
+
+         if ( output != &std::cout )
          {
-            logger.Fatal( "cannot open file '" + filename + "' for output." );
+            delete output;
          }
-         else // FIXME: => read( is, options, context, ctx.keywords ); ??
+         return 0;
+      }
+
+      /*
+       * include compiled-in keywords if requested:
+       */
+      if ( clpBuiltin.isSet() )
+      {
+         context.keywords.use( builtin_stopwords );
+      }
+
+      /*
+       * write keywords as header to compile in, or as precompiled file if requested:
+       */
+      if ( clpMakeKeywords.isSet() )
+      {
+         make_keywords( clpKeywords.isSet() ? clpKeywords.getValue() : "", clpMakeKeywords.getValue() );
+         return 0;
+      }
+
+      if ( clpCompileKeywords.isSet() )
+      {
+         compile_keywords( clpKeywords.isSet() ? clpKeywords.getValue() : "", clpCompileKeywords.getValue() );
+         return 0;
+      }
+
+      /*
+       * read keywords if requested; a precompiled file is used as mapped:
+       */
+      StopwordFile* keyword_file = NULL;
+
+      if ( clpKeywords.isSet() )
+      {
+         const filename_type filename( clpKeywords.getValue() );
+
+         if ( StopwordFile::is_stopword_file( filename ) )
          {
-            Tokenizer tokenizer( is );
-            tokenizer.set_skip_comments();
+            keyword_file = new StopwordFile( filename );
+
+            if ( !keyword_file->is_open() )
+            {
+               logger.Fatal( "keyword file '" + filename + "' is damaged or was compiled for another version or machine." );
+            }
 
-            std::copy
-            ( tokenizer.begin(), tokenizer.end()
-            , std::inserter( context.keywords, context.keywords.begin() )
-            );
+            context.keywords.use( keyword_file->table() );
          }
+         else
+         {
+            std::ifstream is( to_charptr( filename ) );
+
+            if ( !is )
+            {
+               logger.Fatal( "cannot open file '" + filename + "' for output." );
+            }
+            else // FIXME: => read( is, options, context, ctx.keywords ); ??
+            {
+               read_keywords( is, context.keywords );
+            }
+         }
+      }
+
+      /*
+       * in reverse mode, scan for a moderate number of keywords rather than tokenize:
+       */
+      KeywordScanner* scanner = NULL;
+
+      if ( options.reverse && context.keywords.size() <= KeywordScanner::max_keywords )
+      {
+         scanner = new KeywordScanner( context.keywords, options.lowercase );
+         options.scanner = scanner;
       }
 
       /*
@@ -837,32 +2314,59 @@ int main( int argc, char* argv[] )
       }
 
       /*
-       * check files for existence:
+       * process given files, or std::cin if none given; the workers of
+       * --jobs cannot report a missing file, so check all files first.
+       * An index is saved file by file, so that it can be updated later:
        */
-      std::for_each( filename_list.begin(), filename_list.end(), check_file_exists );
+      if ( clpSaveIndex.isSet() )
+      {
+         if ( filename_list.empty() )
+         {
+            filename_list.push_back( filename_list_element_type( "-", 0 ) );
+         }
 
-      /*
-       * process given files, or std::cin if none given:
-       */
-      if ( filename_list.size() <= 0 )
+         save_index( clpSaveIndex.getValue(), filename_list, options, context );
+      }
+      else if ( options.match )
+      {
+         if ( filename_list.empty() )
+         {
+            filename_list.push_back( filename_list_element_type( "-", 0 ) );
+         }
+
+         read_matches( *output, filename_list, options, context );
+      }
+      else if ( filename_list.size() <= 0 )
       {
          read( std::cin, options, context );
       }
+      else if ( options.jobs > 1 && filename_list.size() > 1 )
+      {
+         std::for_each( filename_list.begin(), filename_list.end(), check_file_exists );
+
+         read_files_parallel( filename_list, options, context );
+      }
       else
       {
-         std::for_each
-         ( filename_list.begin(), filename_list.end()
-         , Reader( options, context )
-         );
+         read_files( filename_list, options, context );
       }
 
-      print( *output, options, context );
+      /*
+       * print the words read, unless saved as index or matched:
+       */
+      if ( !clpSaveIndex.isSet() && !options.match )
+      {
+         print( *output, options, context );
+      }
 
 // TODO (Martin#1#): smart-pointer?, leaking?
       if ( output != &std::cout )
       {
          delete output;
       }
+
+      delete scanner;
+      delete keyword_file;
    }
    catch ( clp::ArgException& e )
    {
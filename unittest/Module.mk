@@ -19,6 +19,22 @@ unittests: \
 	unittest/Test-Tokenizer.exe \
 	unittest/Test-Utility.exe \
 	unittest/Test-WordIndex.exe \
+	unittest/Test-WordTrie.exe \
+	unittest/Test-Query.exe \
+	unittest/Test-IndexFile.exe \
+	unittest/Test-OutputBuffer.exe \
+	unittest/Test-FileLoader.exe \
+	unittest/Test-BlockReader.exe \
+	unittest/Test-KeywordScanner.exe \
+	unittest/Test-StopwordFile.exe \
+	unittest/Test-StopwordTable.exe \
+	unittest/Test-KeywordSet.exe \
+	unittest/Test-Postings.exe \
+	unittest/Test-TokenView.exe \
+	unittest/Test-Dictionary.exe \
+	unittest/Test-Merge.exe \
+	unittest/Test-Parallel.exe \
+	unittest/Test-ScanKernel.exe \
 	unittest/Test-Fructose.exe  $(FRUCTOSE_OPTIONS) \
 	unittest/Test-Pair.exe      $(FRUCTOSE_OPTIONS) \
 	unittest/Test-Tokenizer.exe $(FRUCTOSE_OPTIONS)
@@ -34,6 +50,22 @@ unittest/Test-Pair.exe:      unittest/Test-Pair.cpp
 unittest/Test-Utility.exe:   unittest/Test-Utility.cpp
 unittest/Test-Tokenizer.exe: unittest/Test-Tokenizer.cpp
 unittest/Test-WordIndex.exe: unittest/Test-WordIndex.cpp
+unittest/Test-WordTrie.exe: unittest/Test-WordTrie.cpp
+unittest/Test-Query.exe: unittest/Test-Query.cpp
+unittest/Test-IndexFile.exe: unittest/Test-IndexFile.cpp
+unittest/Test-OutputBuffer.exe: unittest/Test-OutputBuffer.cpp
+unittest/Test-FileLoader.exe: unittest/Test-FileLoader.cpp
+unittest/Test-BlockReader.exe: unittest/Test-BlockReader.cpp
+unittest/Test-KeywordScanner.exe: unittest/Test-KeywordScanner.cpp
+unittest/Test-StopwordFile.exe: unittest/Test-StopwordFile.cpp
+unittest/Test-StopwordTable.exe: unittest/Test-StopwordTable.cpp
+unittest/Test-KeywordSet.exe: unittest/Test-KeywordSet.cpp
+unittest/Test-Postings.exe: unittest/Test-Postings.cpp
+unittest/Test-TokenView.exe: unittest/Test-TokenView.cpp
+unittest/Test-Dictionary.exe: unittest/Test-Dictionary.cpp
+unittest/Test-Merge.exe: unittest/Test-Merge.cpp
+unittest/Test-Parallel.exe: unittest/Test-Parallel.cpp
+unittest/Test-ScanKernel.exe: unittest/Test-ScanKernel.cpp
 
 #.cpp.exe:
 #	$(CC) $(CXXFLAGS) -I include -o $*.exe $<
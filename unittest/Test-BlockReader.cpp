@@ -0,0 +1,83 @@
+/*
+ * Test-BlockReader.cpp - test BlockReader.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-BlockReader.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-BlockReader.exe Test-BlockReader.cpp
+
+#include "../src/BlockReader.h"
+#include <Fructose/test_base.h>
+
+#include <sstream>   // for std::istringstream
+#include <string>    // for std::string
+
+using wordindex::BlockReader;
+
+struct test : public fructose::test_base< test >
+{
+   void is_proper_block_sequence( const std::string& test_name )
+   {
+      std::string text;
+      for ( int i = 0; i < 1000; ++i )
+      {
+         text += static_cast< char >( 'a' + i % 26 );
+      }
+
+      std::istringstream is( text );
+      BlockReader reader( is, 64 );
+
+      BlockReader::block_type block;
+      std::string result;
+      int blocks = 0;
+
+      while ( reader.next( block ) )
+      {
+         fructose_assert( block.size() <= 64 );
+         result.append( block.begin(), block.end() );
+         ++blocks;
+      }
+
+      fructose_assert( text == result );
+      fructose_assert( 16 == blocks );  // 15 full blocks and one of 40 characters
+      fructose_assert( !reader.next( block ) );
+   }
+
+   void is_proper_empty_input( const std::string& test_name )
+   {
+      std::istringstream is( "" );
+      BlockReader reader( is, 64 );
+
+      BlockReader::block_type block;
+
+      fructose_assert( reader.next( block ) && block.empty() );
+      fructose_assert( !reader.next( block ) );
+   }
+
+   void is_proper_early_stop( const std::string& test_name )
+   {
+      std::istringstream is( std::string( 10000, 'x' ) );
+      BlockReader::block_type block;
+
+      {
+         BlockReader reader( is, 16, 2 );
+         fructose_assert( reader.next( block ) && 16 == block.size() );
+      }
+
+      fructose_assert( is.tellg() < 10000 );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_block_sequence", &test::is_proper_block_sequence );
+   tests.add_test( "is_proper_empty_input", &test::is_proper_empty_input );
+   tests.add_test( "is_proper_early_stop", &test::is_proper_early_stop );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
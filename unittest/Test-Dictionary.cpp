@@ -0,0 +1,69 @@
+/*
+ * Test-Dictionary.cpp - test Dictionary.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-Dictionary.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-Dictionary.exe Test-Dictionary.cpp
+
+#include "../src/Dictionary.h"
+#include <Fructose/test_base.h>
+
+#include <sstream>   // for std::ostringstream
+#include <string>    // for std::string
+
+using wordindex::Dictionary;
+
+struct test : public fructose::test_base< test >
+{
+   void is_proper_intern( const std::string& test_name )
+   {
+      Dictionary words;
+
+      fructose_assert( words.empty() );
+      fructose_assert( 0 == words.intern( "beta" ) );
+      fructose_assert( 1 == words.intern( "alpha" ) );
+      fructose_assert( 0 == words.intern( "beta" ) );
+      fructose_assert( 2 == words.intern( "" ) );
+
+      fructose_assert( 3 == words.size() );
+      fructose_assert( 9 == words.pool_size() );
+      fructose_assert( "beta" == words.word( 0 ) );
+      fructose_assert( "alpha" == words.word( 1 ) );
+      fructose_assert( words.word( 2 ).empty() );
+      fructose_assert( words.less( 1, 0 ) );
+   }
+
+   void is_proper_growth( const std::string& test_name )
+   {
+      Dictionary words;
+
+      // more words than the initial hash table holds:
+      for ( int i = 0; i < 5000; ++i )
+      {
+         std::ostringstream os; os << "w" << i;
+         fructose_assert( static_cast< Dictionary::id_type >( i ) == words.intern( os.str() ) );
+      }
+
+      for ( int i = 0; i < 5000; ++i )
+      {
+         std::ostringstream os; os << "w" << i;
+         fructose_assert( static_cast< Dictionary::id_type >( i ) == words.intern( os.str() ) );
+         fructose_assert( os.str() == words.word( i ) );
+      }
+      fructose_assert( 5000 == words.size() );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_intern", &test::is_proper_intern );
+   tests.add_test( "is_proper_growth", &test::is_proper_growth );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
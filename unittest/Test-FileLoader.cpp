@@ -0,0 +1,118 @@
+/*
+ * Test-FileLoader.cpp - test batched loading of small files.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-FileLoader.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-FileLoader.exe Test-FileLoader.cpp
+
+#include "../src/FileLoader.h"
+#include <Fructose/test_base.h>
+
+#include <cstdio>    // for std::remove()
+#include <fstream>   // for std::ofstream
+#include <string>    // for std::string
+#include <vector>    // for std::vector<>
+
+using wordindex::FileLoader;
+
+struct test : public fructose::test_base< test >
+{
+   std::vector< std::string > filenames;
+   std::vector< std::string > contents;
+
+   void setup()
+   {
+      filenames.clear();
+      contents.clear();
+
+      for ( int i = 0; i < 300; ++i )
+      {
+         std::string text;
+
+         for ( int k = 0; k < i; ++k )
+         {
+            text += "line " + std::string( 1, static_cast< char >( 'a' + k % 26 ) ) + "\n";
+         }
+
+         add( "Test-FileLoader-" + std::string( 1, static_cast< char >( 'a' + i % 26 ) ) + std::string( 1, static_cast< char >( 'a' + i / 26 ) ) + ".tmp", text );
+      }
+
+      // larger than a small file:
+      add( "Test-FileLoader-large.tmp", std::string( wordindex::small_file_size + 1, 'x' ) );
+   }
+
+   void teardown()
+   {
+      for ( std::size_t i = 0; i < filenames.size(); ++i )
+      {
+         std::remove( filenames[ i ].c_str() );
+      }
+   }
+
+   void add( std::string const& filename, std::string const& text )
+   {
+      std::ofstream os( filename.c_str(), std::ios::binary );
+      os << text;
+
+      filenames.push_back( filename );
+      contents.push_back( text );
+   }
+
+   void check( FileLoader& loader )
+   {
+      std::vector< std::string > names( filenames );
+      names.push_back( "Test-FileLoader-missing.tmp" );
+
+      FileLoader::files_type files;
+      loader.load( names, files );
+
+      fructose_assert( files.size() == names.size() );
+
+      for ( std::size_t i = 0; i + 2 < names.size(); ++i )
+      {
+         fructose_assert( 0 == files[ i ].error );
+         fructose_assert( files[ i ].regular );
+         fructose_assert( files[ i ].loaded );
+         fructose_assert( files[ i ].size == contents[ i ].size() );
+         fructose_assert( std::string( files[ i ].begin(), files[ i ].end() ) == contents[ i ] );
+      }
+
+      std::size_t const large = names.size() - 2;
+
+      fructose_assert( 0 == files[ large ].error );
+      fructose_assert( files[ large ].regular );
+      fructose_assert( !files[ large ].loaded );
+      fructose_assert( files[ large ].size == contents[ large ].size() );
+
+      fructose_assert( 0 != files[ large + 1 ].error );
+      fructose_assert( !files[ large + 1 ].loaded );
+   }
+
+   void is_proper_default_loader( const std::string& test_name )
+   {
+      FileLoader loader;
+      check( loader );
+   }
+
+   void is_proper_threaded_loader( const std::string& test_name )
+   {
+      FileLoader loader( false );
+
+      fructose_assert( !loader.uses_io_uring() );
+      check( loader );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_default_loader", &test::is_proper_default_loader );
+   tests.add_test( "is_proper_threaded_loader", &test::is_proper_threaded_loader );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
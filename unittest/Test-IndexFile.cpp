@@ -0,0 +1,356 @@
+/*
+ * Test-IndexFile.cpp - test the word index saved as memory-mappable file.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-IndexFile.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-IndexFile.exe Test-IndexFile.cpp
+
+#include "../src/IndexFile.h"
+#include <Fructose/test_base.h>
+
+#include <cstdio>    // for std::remove()
+#include <fstream>   // for std::ofstream
+#include <iterator>  // for std::istreambuf_iterator<>
+#include <string>    // for std::string
+#include <vector>    // for std::vector<>
+
+using wordindex::IndexBuilder;
+using wordindex::IndexFile;
+using wordindex::IndexedFile;
+using wordindex::WordIndex;
+using wordindex::WordTrie;
+
+struct test : public fructose::test_base< test >
+{
+   std::string filename;
+
+   void setup()
+   {
+      filename = "Test-IndexFile.tmp";
+   }
+
+   void teardown()
+   {
+      std::remove( filename.c_str() );
+   }
+
+   void save( WordIndex const& index, IndexFile::files_type const& files )
+   {
+      IndexBuilder builder( index.count_only(), 3, 42 );
+      builder.set_started( 999 );
+
+      for ( IndexFile::files_type::const_iterator pos = files.begin(); pos != files.end(); ++pos )
+      {
+         builder.add_file( *pos );
+      }
+
+      builder.add( 0, index );
+      write( builder );
+   }
+
+   void write( IndexBuilder& builder )
+   {
+      std::ofstream os( filename.c_str(), std::ios::binary );
+      builder.write( os );
+   }
+
+   void fill( WordIndex& index, int const first = 0, int const last = 7 )
+   {
+      char const* const words[] = { "zeta", "alpha", "mu", "alpha", "beta", "zeta", "alpha" };
+
+      for ( int i = first; i < last; ++i )
+      {
+         index.insert( words[ i ], 10 * i + 1 );
+      }
+   }
+
+   IndexedFile indexed( char const* name )
+   {
+      IndexedFile file;
+      file.name = name;
+      return file;
+   }
+
+   template < typename I, typename J >
+   void check_equal( I const& expected, J const& actual )
+   {
+      fructose_assert( expected.words() == static_cast< int >( actual.words() ) );
+      fructose_assert( expected.lines() == actual.lines() );
+
+      typename J::const_iterator pos = actual.begin();
+
+      for ( typename I::const_iterator exp = expected.begin(); exp != expected.end(); ++exp, ++pos )
+      {
+         fructose_assert( (*exp).first.str() == (*pos).first.str() );
+         fructose_assert( (*exp).count == (*pos).count );
+         fructose_assert( std::vector< int >( (*exp).second.begin(), (*exp).second.end() ) == std::vector< int >( (*pos).second.begin(), (*pos).second.end() ) );
+      }
+      fructose_assert( pos == actual.end() );
+   }
+
+   void is_proper_roundtrip( const std::string& test_name )
+   {
+      WordIndex index;
+      fill( index );
+
+      IndexFile::files_type files( 2 );
+      files[ 0 ].name = "first.txt";  files[ 0 ].size = 123; files[ 0 ].time = 456;
+      files[ 1 ].name = "second.txt"; files[ 1 ].size = 789; files[ 1 ].time = 12; files[ 1 ].hash = 345;
+
+      save( index, files );
+
+      fructose_assert( IndexFile::is_index_file( filename ) );
+
+      IndexFile const loaded( filename );
+
+      fructose_assert( loaded.is_open() );
+      fructose_assert( !loaded.count_only() );
+      fructose_assert( 3 == loaded.keywords() );
+      fructose_assert( 2 == loaded.files().size() );
+      fructose_assert( "second.txt" == loaded.files()[ 1 ].name );
+      fructose_assert( 789 == loaded.files()[ 1 ].size );
+      fructose_assert( 12 == loaded.files()[ 1 ].time );
+      fructose_assert( 345 == loaded.files()[ 1 ].hash );
+      fructose_assert( 42 == loaded.signature() );
+      fructose_assert( 999 == loaded.started() );
+
+      check_equal( index, loaded );
+   }
+
+   void is_proper_find( const std::string& test_name )
+   {
+      WordIndex index;
+      fill( index );
+      save( index, IndexFile::files_type( 1 ) );
+
+      IndexFile const loaded( filename );
+
+      char const* const words[] = { "alpha", "beta", "mu", "zeta" };
+
+      for ( int i = 0; i < 4; ++i )
+      {
+         IndexFile::const_iterator const pos = loaded.find( words[ i ] );
+
+         fructose_assert( pos != loaded.end() );
+         fructose_assert( words[ i ] == (*pos).first.str() );
+         fructose_assert( (*index.find( words[ i ] )).count == (*pos).count );
+      }
+
+      fructose_assert( loaded.end() == loaded.find( "" ) );
+      fructose_assert( loaded.end() == loaded.find( "aardvark" ) );
+      fructose_assert( loaded.end() == loaded.find( "gamma" ) );
+      fructose_assert( loaded.end() == loaded.find( "zz" ) );
+   }
+
+   void is_proper_trie( const std::string& test_name )
+   {
+      WordIndex index;
+      fill( index );
+      save( index, IndexFile::files_type( 1 ) );
+
+      IndexFile const loaded( filename );
+
+      // words: alpha, beta, mu, zeta:
+      fructose_assert( 4 == loaded.trie().words() );
+      fructose_assert( WordTrie::range_type( 0, 4 ) == loaded.trie().prefix_range( "" ) );
+      fructose_assert( WordTrie::range_type( 1, 2 ) == loaded.trie().prefix_range( "b" ) );
+      fructose_assert( WordTrie::range_type( 3, 4 ) == loaded.trie().prefix_range( "zeta" ) );
+      fructose_assert( loaded.trie().prefix_range( "zetas" ).first == loaded.trie().prefix_range( "zetas" ).second );
+
+      WordTrie::numbers_type numbers;
+      loaded.trie().match( "*a", numbers );
+
+      fructose_assert( 3 == numbers.size() );
+      fructose_assert( 0 == numbers[ 0 ] && 1 == numbers[ 1 ] && 3 == numbers[ 2 ] );
+   }
+
+   void is_proper_segments( const std::string& test_name )
+   {
+      // words of three files, the last one read first:
+      WordIndex whole, first, second, third;
+      fill( whole, 0, 3 ); fill( whole, 3, 5 ); fill( whole, 5, 7 );
+      fill( first, 0, 3 ); fill( second, 3, 5 ); fill( third, 5, 7 );
+
+      IndexBuilder builder( false, 3, 42 );
+      std::size_t const c = builder.add_file( indexed( "c" ) );
+      builder.add( c, third );
+      builder.add( builder.add_file( indexed( "a" ) ), first );
+      builder.add( builder.add_file( indexed( "b" ) ), second );
+
+      write( builder );
+
+      IndexFile const loaded( filename );
+
+      fructose_assert( loaded.is_open() );
+      fructose_assert( 3 == loaded.files().size() );
+      fructose_assert( "c" == loaded.files()[ 0 ].name );
+
+      // the segments are ordered on file number:
+      WordIndex expected;
+      fill( expected, 5, 7 ); fill( expected, 0, 3 ); fill( expected, 3, 5 );
+
+      check_equal( expected, loaded );
+   }
+
+   void is_proper_update( const std::string& test_name )
+   {
+      WordIndex first, second, third;
+      fill( first, 0, 3 ); fill( second, 3, 5 ); fill( third, 5, 7 );
+
+      {
+         IndexBuilder builder( false, 3, 42 );
+         builder.add( builder.add_file( indexed( "a" ) ), first );
+         builder.add( builder.add_file( indexed( "b" ) ), second );
+         builder.add( builder.add_file( indexed( "c" ) ), third );
+         write( builder );
+      }
+
+      // drop file a, keep c as first file, add d between them:
+      IndexBuilder builder( false, 3, 42 );
+      {
+         IndexFile const earlier( filename );
+         fructose_assert( earlier.is_open() );
+
+         std::vector< IndexBuilder::size_type > numbers( 3, IndexBuilder::npos );
+         numbers[ 2 ] = builder.add_file( earlier.files()[ 2 ] );
+
+         WordIndex added;
+         added.insert( "alpha", 5 );
+         added.insert( "omega", 6 );
+         builder.add( builder.add_file( indexed( "d" ) ), added );
+
+         numbers[ 1 ] = builder.add_file( earlier.files()[ 1 ] );
+
+         builder.add( earlier, numbers );
+      }
+      write( builder );
+
+      IndexFile const loaded( filename );
+
+      WordIndex expected;
+      fill( expected, 5, 7 );
+      expected.insert( "alpha", 5 );
+      expected.insert( "omega", 6 );
+      fill( expected, 3, 5 );
+
+      fructose_assert( loaded.is_open() );
+      fructose_assert( 3 == loaded.files().size() );
+      fructose_assert( "b" == loaded.files()[ 2 ].name );
+
+      check_equal( expected, loaded );
+   }
+
+   void is_proper_locations( const std::string& test_name )
+   {
+      WordIndex first, second, third;
+      fill( first, 0, 3 ); fill( second, 3, 5 ); fill( third, 5, 7 );
+
+      // files added out of order: c, a, b as files 0, 2, 1:
+      IndexBuilder builder( false, 3, 42 );
+      builder.add( builder.add_file( indexed( "c" ) ), third );
+      std::size_t const b = builder.add_file( indexed( "b" ) );
+      builder.add( builder.add_file( indexed( "a" ) ), first );
+      builder.add( b, second );
+
+      write( builder );
+
+      IndexFile const loaded( filename );
+
+      wordindex::locations_type alpha;
+      loaded.locations( "alpha", alpha );
+
+      wordindex::locations_type expected;
+      expected.push_back( wordindex::location( 0, 61 ) );
+      expected.push_back( wordindex::location( 1, 31 ) );
+      expected.push_back( wordindex::location( 2, 11 ) );
+
+      fructose_assert( expected == alpha );
+
+      wordindex::locations_type none;
+      loaded.locations( "gamma", none );
+
+      fructose_assert( none.empty() );
+   }
+
+   void is_proper_count_only( const std::string& test_name )
+   {
+      WordIndex index;
+      index.set_count_only( true );
+      fill( index );
+
+      save( index, IndexFile::files_type() );
+
+      IndexFile const loaded( filename );
+
+      fructose_assert( loaded.is_open() );
+      fructose_assert( loaded.count_only() );
+      fructose_assert( 0 == loaded.files().size() );
+
+      check_equal( index, loaded );
+   }
+
+   void is_proper_empty_index( const std::string& test_name )
+   {
+      save( WordIndex(), IndexFile::files_type() );
+
+      IndexFile const loaded( filename );
+
+      fructose_assert( loaded.is_open() );
+      fructose_assert( 0 == loaded.words() );
+      fructose_assert( 0 == loaded.trie().nodes() );
+      fructose_assert( loaded.begin() == loaded.end() );
+   }
+
+   void is_proper_damaged_rejection( const std::string& test_name )
+   {
+      WordIndex index;
+      fill( index );
+      save( index, IndexFile::files_type() );
+
+      std::string text;
+      {
+         std::ifstream is( filename.c_str(), std::ios::binary );
+         text.assign( std::istreambuf_iterator< char >( is ), std::istreambuf_iterator< char >() );
+      }
+
+      // truncated:
+      {
+         std::ofstream os( filename.c_str(), std::ios::binary );
+         os.write( text.data(), text.size() - 1 );
+      }
+      fructose_assert( !IndexFile( filename ).is_open() );
+
+      // other version:
+      {
+         std::string other( text );
+         ++other[ 4 ];
+         std::ofstream os( filename.c_str(), std::ios::binary );
+         os.write( other.data(), other.size() );
+      }
+      fructose_assert( IndexFile::is_index_file( filename ) );
+      fructose_assert( !IndexFile( filename ).is_open() );
+
+      fructose_assert( !IndexFile( "Test-IndexFile-missing.tmp" ).is_open() );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_roundtrip", &test::is_proper_roundtrip );
+   tests.add_test( "is_proper_find", &test::is_proper_find );
+   tests.add_test( "is_proper_trie", &test::is_proper_trie );
+   tests.add_test( "is_proper_segments", &test::is_proper_segments );
+   tests.add_test( "is_proper_update", &test::is_proper_update );
+   tests.add_test( "is_proper_locations", &test::is_proper_locations );
+   tests.add_test( "is_proper_count_only", &test::is_proper_count_only );
+   tests.add_test( "is_proper_empty_index", &test::is_proper_empty_index );
+   tests.add_test( "is_proper_damaged_rejection", &test::is_proper_damaged_rejection );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
@@ -0,0 +1,142 @@
+/*
+ * Test-KeywordScanner.cpp - test KeywordScanner.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-KeywordScanner.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-KeywordScanner.exe Test-KeywordScanner.cpp
+
+#include "../src/KeywordScanner.h"
+#include <Fructose/test_base.h>
+
+#include <cstdlib>   // for rand()
+#include <string>    // for std::string
+#include <utility>   // for std::pair<>
+#include <vector>    // for std::vector<>
+
+using wordindex::KeywordScanner;
+using wordindex::KeywordSet;
+using wordindex::RangeTokenizer;
+using wordindex::TokenView;
+
+/**
+ * collect the (word, line) pairs found.
+ */
+struct Found
+{
+   typedef std::vector< std::pair< std::string, int > > list_type;
+
+   Found() : proper_hashes( true ) { ; }
+
+   void insert( TokenView const& word, wordindex::hash_type const hash, int const line )
+   {
+      proper_hashes = proper_hashes && hash == wordindex::hash_bytes( word.begin(), word.end() );
+      list.push_back( std::make_pair( word.str(), line ) );
+   }
+
+   list_type list;
+   bool proper_hashes;
+};
+
+struct test : public fructose::test_base< test >
+{
+   /**
+    * the keywords in text as the range tokenizer finds them.
+    */
+   static Found::list_type tokenize( std::string const& text, KeywordSet const& keywords, bool const lowercase )
+   {
+      Found found;
+      RangeTokenizer tokenizer( text.data(), text.data() + text.size() );
+      tokenizer.set_lowercase( lowercase );
+
+      for ( RangeTokenizer::iterator pos = tokenizer.begin(); pos != tokenizer.end(); ++pos )
+      {
+         if ( keywords.contains( (*pos).first, pos.hash() ) )
+         {
+            found.insert( (*pos).first, pos.hash(), (*pos).second );
+         }
+      }
+      return found.list;
+   }
+
+   /**
+    * the keywords in text as the scanner finds them.
+    */
+   static Found::list_type scan( std::string const& text, KeywordSet const& keywords, bool const lowercase )
+   {
+      Found found;
+      KeywordScanner const scanner( keywords, lowercase );
+
+      scanner.scan( text.data(), text.data() + text.size(), found );
+      return found.proper_hashes ? found.list : Found::list_type( 1 );
+   }
+
+   void is_proper_scan( const std::string& test_name )
+   {
+      KeywordSet keywords;
+      keywords.insert( "the" );
+      keywords.insert( "he" );
+      keywords.insert( "a" );
+      keywords.insert( "a1" );
+
+      const std::string text( "the then he\nathe a1 9he _the he2\n\nA The a" );
+
+      Found::list_type const found = scan( text, keywords, false );
+
+      fructose_assert( found == tokenize( text, keywords, false ) );
+      fructose_assert( 5 == found.size() );
+      fructose_assert( found[ 0 ] == std::make_pair( std::string( "the" ), 1 ) );
+      fructose_assert( found[ 2 ] == std::make_pair( std::string( "a1" ), 2 ) );
+      fructose_assert( found[ 3 ] == std::make_pair( std::string( "he" ), 2 ) );
+      fructose_assert( found[ 4 ] == std::make_pair( std::string( "a" ), 4 ) );
+
+      fructose_assert( scan( text, keywords, true ) == tokenize( text, keywords, true ) );
+      fructose_assert( 7 == scan( text, keywords, true ).size() );
+   }
+
+   void is_proper_random_scan( const std::string& test_name )
+   {
+      const std::string alphabet = "abAB_1 \n;";
+
+      KeywordSet keywords;
+      keywords.insert( "ab" );
+      keywords.insert( "b" );
+      keywords.insert( "ba_1" );
+      keywords.insert( "aab" );
+
+      for ( int round = 0; round < 100; ++round )
+      {
+         std::string text;
+         for ( int i = 0; i < 200; ++i )
+         {
+            text += alphabet[ rand() % alphabet.size() ];
+         }
+
+         fructose_assert( scan( text, keywords, false ) == tokenize( text, keywords, false ) );
+         fructose_assert( scan( text, keywords, true  ) == tokenize( text, keywords, true  ) );
+      }
+   }
+
+   void is_proper_empty_set( const std::string& test_name )
+   {
+      KeywordSet keywords;
+      KeywordScanner const scanner( keywords, false );
+
+      fructose_assert( 1 + KeywordScanner::skip_run == scanner.states() );  // root and skip states
+      fructose_assert( scan( "the a b", keywords, false ).empty() );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_scan", &test::is_proper_scan );
+   tests.add_test( "is_proper_random_scan", &test::is_proper_random_scan );
+   tests.add_test( "is_proper_empty_set", &test::is_proper_empty_set );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
@@ -0,0 +1,72 @@
+/*
+ * Test-KeywordSet.cpp - test KeywordSet.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-KeywordSet.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-KeywordSet.exe Test-KeywordSet.cpp
+
+#include "../src/KeywordSet.h"
+#include <Fructose/test_base.h>
+
+#include <sstream>   // for std::ostringstream
+#include <string>    // for std::string
+
+using wordindex::KeywordSet;
+using wordindex::TokenView;
+
+struct test : public fructose::test_base< test >
+{
+   void is_proper_lookup( const std::string& test_name )
+   {
+      KeywordSet keywords;
+
+      fructose_assert( keywords.empty() );
+      fructose_assert( 0 == keywords.count( "the" ) );
+
+      keywords.insert( "the" );
+      keywords.insert( "a" );
+      keywords.insert( "the" );
+
+      fructose_assert( 2 == keywords.size() );
+      fructose_assert( 1 == keywords.count( "the" ) );
+      fructose_assert( 0 == keywords.count( "then" ) );
+
+      const std::string text( "then the" );
+      TokenView const the( text.data() + 5, text.data() + 8 );
+      TokenView const then( text.data(), text.data() + 4 );
+
+      fructose_assert(  keywords.contains( the , wordindex::hash_bytes( the.begin() , the.end()  ) ) );
+      fructose_assert( !keywords.contains( then, wordindex::hash_bytes( then.begin(), then.end() ) ) );
+   }
+
+   void is_proper_large_set( const std::string& test_name )
+   {
+      KeywordSet keywords;
+
+      for ( int i = 0; i < 50000; i += 2 )
+      {
+         std::ostringstream os; os << "k" << i;
+         keywords.insert( os.str() );
+      }
+
+      for ( int i = 0; i < 50000; ++i )
+      {
+         std::ostringstream os; os << "k" << i;
+         fructose_assert( ( 0 == i % 2 ) == ( 1 == keywords.count( os.str() ) ) );
+      }
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_lookup", &test::is_proper_lookup );
+   tests.add_test( "is_proper_large_set", &test::is_proper_large_set );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
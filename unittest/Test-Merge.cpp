@@ -0,0 +1,98 @@
+/*
+ * Test-Merge.cpp - test PartialIndex and merge_parallel().
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-Merge.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-Merge.exe Test-Merge.cpp
+
+#include "../src/Merge.h"
+#include <Fructose/test_base.h>
+
+#include <string>    // for std::string
+
+using wordindex::PartialIndex;
+using wordindex::WordIndex;
+
+struct test : public fructose::test_base< test >
+{
+   static std::vector< int > lines( wordindex::Postings const& postings )
+   {
+      return std::vector< int >( postings.begin(), postings.end() );
+   }
+
+   void is_proper_merge_order( const std::string& test_name )
+   {
+      PartialIndex part1;
+      PartialIndex part2;
+
+      // files read out of order: part1 reads files 2 and 0, part2 reads file 1:
+      part1.set_file( 2 ); part1.insert( "b", 7 ); part1.insert( "a", 1 );
+      part1.set_file( 0 ); part1.insert( "a", 3 ); part1.insert( "a", 5 ); part1.insert( "c", 2 );
+      part2.set_file( 1 ); part2.insert( "a", 4 ); part2.insert( "b", 1 ); part2.insert( "d", 9 );
+
+      part1.sort();
+      part2.sort();
+
+      std::vector< PartialIndex const* > parts;
+      parts.push_back( &part1 );
+      parts.push_back( &part2 );
+
+      WordIndex result;
+      wordindex::merge_parallel( parts, result, 3 );
+
+      fructose_assert( 4 == result.words() );
+      fructose_assert( 8 == result.lines() );
+
+      WordIndex::const_iterator pos = result.begin();
+
+      int const a[] = { 3, 5, 4, 1 };
+      fructose_assert( "a" == pos->first && lines( pos->second ) == std::vector< int >( a, a + 4 ) ); ++pos;
+
+      int const b[] = { 1, 7 };
+      fructose_assert( "b" == pos->first && lines( pos->second ) == std::vector< int >( b, b + 2 ) ); ++pos;
+
+      fructose_assert( "c" == pos->first && 1 == pos->second.size() ); ++pos;
+      fructose_assert( "d" == pos->first && 1 == pos->second.size() ); ++pos;
+      fructose_assert( result.end() == pos );
+   }
+
+   void is_proper_append( const std::string& test_name )
+   {
+      PartialIndex chunk1;
+      PartialIndex chunk2;
+
+      // two chunks of file 1, the second starting at line 10:
+      chunk1.insert( "a", 2 ); chunk1.insert( "b", 3 );
+      chunk2.insert( "a", 1 ); chunk2.insert( "a", 4 );
+
+      PartialIndex part;
+      part.set_file( 1 ); part.append( chunk1 ); part.append( chunk2, 10 );
+      part.set_file( 0 ); part.insert( "a", 8 );
+      part.sort();
+
+      fructose_assert( 5 == part.lines() );
+      fructose_assert( 2 == part.words() );
+
+      std::vector< PartialIndex const* > parts( 1, &part );
+
+      WordIndex result;
+      wordindex::merge_parallel( parts, result, 2 );
+
+      int const a[] = { 8, 2, 11, 14 };
+      fructose_assert( "a" == result.begin()->first && lines( result.begin()->second ) == std::vector< int >( a, a + 4 ) );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_merge_order", &test::is_proper_merge_order );
+   tests.add_test( "is_proper_append", &test::is_proper_append );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
@@ -0,0 +1,184 @@
+/*
+ * Test-OutputBuffer.cpp - test buffered output with fast number formatting.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-OutputBuffer.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-OutputBuffer.exe Test-OutputBuffer.cpp
+
+#include "../src/OutputBuffer.h"
+#include <Fructose/test_base.h>
+
+#include <climits>   // for LLONG_MIN etc.
+#include <cstdio>    // for std::tmpfile()
+#include <cstdlib>   // for rand()
+#include <iomanip>   // for std::setw() etc.
+#include <sstream>   // for std::ostringstream
+#include <string>    // for std::string
+
+#ifndef _WIN32
+# include <unistd.h> // for lseek(), read()
+#endif
+
+using wordindex::OutputBuffer;
+
+struct test : public fructose::test_base< test >
+{
+   template < typename T >
+   static std::string expected_integer( T const value, int const width )
+   {
+      std::ostringstream os;
+      os << std::setw( width ) << std::right << value;
+      return os.str();
+   }
+
+   template < typename T >
+   static std::string integer( T const value, int const width )
+   {
+      OutputBuffer out;
+      out.write_integer( value, width );
+      return std::string( out.data(), out.size() );
+   }
+
+   static std::string expected_fixed( double const value, int const precision, int const width )
+   {
+      std::ostringstream os;
+      os << std::fixed << std::setw( width ) << std::setprecision( precision ) << value;
+      return os.str();
+   }
+
+   static std::string fixed( double const value, int const precision, int const width )
+   {
+      OutputBuffer out;
+      out.write_fixed( value, precision, width );
+      return std::string( out.data(), out.size() );
+   }
+
+   void is_proper_integer( const std::string& test_name )
+   {
+      fructose_assert_eq( integer( 0, 0 ), expected_integer( 0, 0 ) );
+      fructose_assert_eq( integer( 42, 6 ), expected_integer( 42, 6 ) );
+      fructose_assert_eq( integer( -42, 6 ), expected_integer( -42, 6 ) );
+      fructose_assert_eq( integer( 1234567, 3 ), expected_integer( 1234567, 3 ) );
+      fructose_assert_eq( integer( INT_MAX, 0 ), expected_integer( INT_MAX, 0 ) );
+      fructose_assert_eq( integer( INT_MIN, 0 ), expected_integer( INT_MIN, 0 ) );
+      fructose_assert_eq( integer( LLONG_MIN, 0 ), expected_integer( LLONG_MIN, 0 ) );
+      fructose_assert_eq( integer( ULLONG_MAX, 30 ), expected_integer( ULLONG_MAX, 30 ) );
+
+      for ( int i = 0; i < 10000; ++i )
+      {
+         int const value = rand() - RAND_MAX / 2;
+         fructose_assert_eq( integer( value, i % 12 ), expected_integer( value, i % 12 ) );
+      }
+   }
+
+   void is_proper_fixed( const std::string& test_name )
+   {
+      // exact halves, which round to even:
+      fructose_assert_eq( fixed( 0.0625, 3, 3 ), expected_fixed( 0.0625, 3, 3 ) );
+      fructose_assert_eq( fixed( 0.1875, 3, 3 ), expected_fixed( 0.1875, 3, 3 ) );
+      fructose_assert_eq( fixed( 2.5, 0, 0 ), expected_fixed( 2.5, 0, 0 ) );
+      fructose_assert_eq( fixed( 0.0005, 3, 0 ), expected_fixed( 0.0005, 3, 0 ) );
+      fructose_assert_eq( fixed( 100.0, 3, 3 ), expected_fixed( 100.0, 3, 3 ) );
+      fructose_assert_eq( fixed( 0.0, 3, 10 ), expected_fixed( 0.0, 3, 10 ) );
+      fructose_assert_eq( fixed( -1.25, 1, 6 ), expected_fixed( -1.25, 1, 6 ) );
+      fructose_assert_eq( fixed( 1e300, 2, 0 ), expected_fixed( 1e300, 2, 0 ) );
+
+      for ( int i = 0; i < 100000; ++i )
+      {
+         int const total = 1 + rand() % 100000;
+         int const count = rand() % ( total + 1 );
+         double const perct = 100.0 * count / total;
+
+         fructose_assert_eq( fixed( perct, 3, 3 ), expected_fixed( perct, 3, 3 ) );
+         fructose_assert_eq( fixed( perct, i % 10, 8 ), expected_fixed( perct, i % 10, 8 ) );
+      }
+   }
+
+   void is_proper_padding( const std::string& test_name )
+   {
+      OutputBuffer out;
+      out.write( "word", 8 );
+      out.write( "  " );
+      out.write( std::string( "longer than width" ), 4 );
+      out.put( 2, '-' );
+      out.put( '\n' );
+
+      fructose_assert_eq( std::string( out.data(), out.size() ), std::string( "    word  longer than width--\n" ) );
+
+      out.clear();
+      fructose_assert( 0 == out.size() );
+   }
+
+   void is_proper_stream_output( const std::string& test_name )
+   {
+      std::ostringstream os;
+      std::string expected;
+      {
+         OutputBuffer out( os, 16 );
+
+         for ( int i = 0; i < 1000; ++i )
+         {
+            out.write_integer( i, 5 );
+            out.put( '\n' );
+            expected += expected_integer( i, 5 ) + "\n";
+         }
+      }
+      fructose_assert_eq( os.str(), expected );
+   }
+
+   void fill( std::deque< OutputBuffer >& buffers, std::string& expected )
+   {
+      for ( std::size_t i = 0; i < buffers.size(); ++i )
+      {
+         // leave one buffer empty:
+         for ( std::size_t k = 0; 2 != i && k < 1000 * i; ++k )
+         {
+            buffers[ i ].write_integer( k, 7 );
+            expected += expected_integer( k, 7 );
+         }
+      }
+   }
+
+   void is_proper_ordered_write( const std::string& test_name )
+   {
+      std::deque< OutputBuffer > buffers( 5 );
+      std::string expected;
+      fill( buffers, expected );
+
+      std::ostringstream os;
+      wordindex::write_buffers( os, buffers );
+
+      fructose_assert( os.str() == expected );
+
+#ifndef _WIN32
+      std::FILE* file = std::tmpfile();
+      int const fd = fileno( file );
+
+      fructose_assert( wordindex::write_buffers( fd, buffers ) );
+
+      std::string text( expected.size() + 1, '\0' );
+      lseek( fd, 0, SEEK_SET );
+      text.resize( read( fd, &text[ 0 ], text.size() ) );
+      std::fclose( file );
+
+      fructose_assert( text == expected );
+#endif
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_integer", &test::is_proper_integer );
+   tests.add_test( "is_proper_fixed", &test::is_proper_fixed );
+   tests.add_test( "is_proper_padding", &test::is_proper_padding );
+   tests.add_test( "is_proper_stream_output", &test::is_proper_stream_output );
+   tests.add_test( "is_proper_ordered_write", &test::is_proper_ordered_write );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
@@ -0,0 +1,82 @@
+/*
+ * Test-Parallel.cpp - test parallel helpers.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-Parallel.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-Parallel.exe Test-Parallel.cpp
+
+#include "../src/Parallel.h"
+#include <Fructose/test_base.h>
+
+#include <string>    // for std::string
+
+using wordindex::split_lines;
+using wordindex::WorkQueues;
+
+struct test : public fructose::test_base< test >
+{
+   void is_proper_newline_aligned_split( const std::string& test_name )
+   {
+      const std::string text = "aaa\nbbb\nccc\nddd\neee\nfff";
+
+      char const* const first = text.data();
+      char const* const last  = text.data() + text.size();
+
+      std::vector< char const* > const bounds = split_lines( first, last, 3 );
+
+      fructose_assert( bounds.front() == first );
+      fructose_assert( bounds.back()  == last  );
+      fructose_assert( bounds.size()  <= 4 );
+
+      for ( std::size_t i = 1; i + 1 < bounds.size(); ++i )
+      {
+         fructose_assert( '\n' == bounds[ i ][ -1 ] );
+         fructose_assert( bounds[ i - 1 ] < bounds[ i ] );
+      }
+   }
+
+   void is_proper_split_without_newlines( const std::string& test_name )
+   {
+      const std::string text = "one long line without a newline";
+
+      std::vector< char const* > const bounds = split_lines( text.data(), text.data() + text.size(), 4 );
+
+      fructose_assert( 2 == bounds.size() );
+   }
+
+   void is_proper_largest_first_schedule( const std::string& test_name )
+   {
+      int const costs[] = { 10, 50, 20, 40, 30 };
+
+      WorkQueues queues( 2 );
+      wordindex::schedule_largest_first( queues, std::vector< int >( costs, costs + 5 ) );
+
+      int task = -1;
+
+      // own queue, largest first: worker 0 has tasks 1, 4 and 0; worker 1 has 3 and 2:
+      fructose_assert( queues.pop( 0, task ) && 1 == task );
+      fructose_assert( queues.pop( 1, task ) && 3 == task );
+      fructose_assert( queues.pop( 1, task ) && 2 == task );
+
+      // worker 1 steals the smallest task of worker 0:
+      fructose_assert( queues.pop( 1, task ) && 0 == task );
+      fructose_assert( queues.pop( 0, task ) && 4 == task );
+
+      fructose_assert( !queues.pop( 0, task ) && !queues.pop( 1, task ) );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_newline_aligned_split", &test::is_proper_newline_aligned_split );
+   tests.add_test( "is_proper_split_without_newlines", &test::is_proper_split_without_newlines );
+   tests.add_test( "is_proper_largest_first_schedule", &test::is_proper_largest_first_schedule );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
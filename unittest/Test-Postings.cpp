@@ -0,0 +1,93 @@
+/*
+ * Test-Postings.cpp - test Postings.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-Postings.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-Postings.exe Test-Postings.cpp
+
+#include "../src/Postings.h"
+#include <Fructose/test_base.h>
+
+#include <string>    // for std::string
+#include <vector>    // for std::vector
+
+using wordindex::Postings;
+
+struct test : public fructose::test_base< test >
+{
+   static std::vector< int > lines( Postings const& postings )
+   {
+      return std::vector< int >( postings.begin(), postings.end() );
+   }
+
+   void is_proper_round_trip( const std::string& test_name )
+   {
+      // ascending, repeated, a step back (next file) and large values:
+      int const a[] = { 1, 2, 2, 130, 20000, 3, 2000000000, 0, 7 };
+      std::vector< int > const expected( a, a + sizeof a / sizeof a[0] );
+
+      Postings postings;
+
+      fructose_assert( postings.empty() );
+      fructose_assert( postings.begin() == postings.end() );
+
+      for ( std::size_t i = 0; i < expected.size(); ++i )
+      {
+         postings.push_back( expected[ i ] );
+      }
+
+      fructose_assert( expected.size() == postings.size() );
+      fructose_assert( 7 == postings.back() );
+      fructose_assert( expected == lines( postings ) );
+   }
+
+   void is_proper_compression( const std::string& test_name )
+   {
+      Postings postings;
+
+      for ( int line = 1; line <= 1000; ++line )
+      {
+         postings.push_back( line );
+      }
+
+      // each difference of one fits in a byte:
+      fructose_assert( 1000 == postings.encoded_size() );
+   }
+
+   void is_proper_append( const std::string& test_name )
+   {
+      Postings postings;
+      Postings other;
+
+      postings.push_back( 5 );
+      postings.push_back( 9 );
+      other.push_back( 1 );
+      other.push_back( 4 );
+      other.push_back( 300 );
+
+      postings.append( other, 10 );
+
+      int const a[] = { 5, 9, 11, 14, 310 };
+      fructose_assert( 5 == postings.size() );
+      fructose_assert( 310 == postings.back() );
+      fructose_assert( std::vector< int >( a, a + 5 ) == lines( postings ) );
+
+      postings.append( Postings() );
+      fructose_assert( 5 == postings.size() );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_round_trip", &test::is_proper_round_trip );
+   tests.add_test( "is_proper_compression", &test::is_proper_compression );
+   tests.add_test( "is_proper_append", &test::is_proper_append );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
@@ -0,0 +1,169 @@
+/*
+ * Test-Query.cpp - test boolean word queries and their set operations.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-Query.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-Query.exe Test-Query.cpp
+
+#include "../src/Query.h"
+#include <Fructose/test_base.h>
+
+#include <algorithm> // for std::set_intersection(), std::set_difference()
+#include <cstdlib>   // for rand()
+#include <iterator>  // for std::back_inserter()
+#include <map>       // for std::map<>
+#include <string>    // for std::string
+
+using wordindex::BooleanQuery;
+using wordindex::locations_type;
+
+struct test : public fructose::test_base< test >
+{
+   /**
+    * the locations of a few words.
+    */
+   class Lookup
+   {
+   public:
+      Lookup()
+      {
+         add( "foo", 1 ); add( "foo", 2 ); add( "foo", 3 ); add( "foo", 5 );
+         add( "bar", 2 ); add( "bar", 3 ); add( "bar", 4 );
+         add( "baz", 3 ); add( "baz", 9 );
+      }
+
+      locations_type const& operator()( std::string const& word )
+      {
+         return m_words[ word ];
+      }
+
+   private:
+      void add( std::string const& word, int const line )
+      {
+         m_words[ word ].push_back( wordindex::location( 0, line ) );
+      }
+
+      std::map< std::string, locations_type > m_words;
+   };
+
+   static locations_type random_list( std::size_t const size, int const range )
+   {
+      locations_type result;
+
+      for ( std::size_t i = 0; i < size; ++i )
+      {
+         result.push_back( rand() % range );
+      }
+
+      std::sort( result.begin(), result.end() );
+      result.erase( std::unique( result.begin(), result.end() ), result.end() );
+
+      return result;
+   }
+
+   static std::string lines( BooleanQuery const& query )
+   {
+      Lookup lookup;
+      locations_type found;
+      query.evaluate( lookup, found );
+
+      std::string result;
+
+      for ( locations_type::const_iterator pos = found.begin(); pos != found.end(); ++pos )
+      {
+         result += static_cast< char >( '0' + wordindex::line_of( *pos ) );
+      }
+      return result;
+   }
+
+   void is_proper_set_operations( const std::string& test_name )
+   {
+      // sizes that take both the walking and the galloping paths:
+      std::size_t const sizes[] = { 0, 1, 10, 100, 1000, 5000 };
+
+      for ( int i = 0; i < 6; ++i )
+      {
+         for ( int j = 0; j < 6; ++j )
+         {
+            locations_type const a = random_list( sizes[ i ], 20000 );
+            locations_type const b = random_list( sizes[ j ], 20000 );
+
+            locations_type expected, actual;
+
+            std::set_intersection( a.begin(), a.end(), b.begin(), b.end(), std::back_inserter( expected ) );
+            wordindex::intersect( a, b, actual );
+            fructose_assert( expected == actual );
+
+            expected.clear();
+            std::set_difference( a.begin(), a.end(), b.begin(), b.end(), std::back_inserter( expected ) );
+            wordindex::subtract( a, b, actual );
+            fructose_assert( expected == actual );
+
+            expected.clear();
+            std::set_union( a.begin(), a.end(), b.begin(), b.end(), std::back_inserter( expected ) );
+            wordindex::unite( a, b, actual );
+            fructose_assert( expected == actual );
+         }
+      }
+   }
+
+   void is_proper_gallop( const std::string& test_name )
+   {
+      locations_type const list = random_list( 1000, 5000 );
+
+      for ( wordindex::location_type value = 0; value < 5002; ++value )
+      {
+         fructose_assert( std::lower_bound( list.begin(), list.end(), value ) == wordindex::gallop( list.begin(), list.end(), value ) );
+      }
+   }
+
+   void is_proper_evaluation( const std::string& test_name )
+   {
+      fructose_assert( "1235"  == lines( BooleanQuery( "foo" ) ) );
+      fructose_assert( "23"    == lines( BooleanQuery( "foo AND bar" ) ) );
+      fructose_assert( "12345" == lines( BooleanQuery( "foo OR bar" ) ) );
+      fructose_assert( "15"    == lines( BooleanQuery( "foo NOT bar" ) ) );
+      fructose_assert( "15"    == lines( BooleanQuery( "foo AND NOT bar" ) ) );
+      fructose_assert( "2"     == lines( BooleanQuery( "foo AND bar NOT baz" ) ) );
+      fructose_assert( "239"   == lines( BooleanQuery( "foo AND bar OR baz" ) ) );
+      fructose_assert( "3"     == lines( BooleanQuery( "foo AND (bar AND baz)" ) ) );
+      fructose_assert( "1359"  == lines( BooleanQuery( "( foo OR baz ) NOT ( bar NOT baz ) NOT qux" ) ) );
+      fructose_assert( ""      == lines( BooleanQuery( "qux AND foo" ) ) );
+      fructose_assert( "1235"  == lines( BooleanQuery( "FOO", true ) ) );
+   }
+
+   void is_proper_syntax_check( const std::string& test_name )
+   {
+      fructose_assert( BooleanQuery( "foo AND ( bar OR baz )" ).is_valid() );
+      fructose_assert( 3 == BooleanQuery( "foo AND ( bar OR baz )" ).words().size() );
+
+      fructose_assert( !BooleanQuery( "" ).is_valid() );
+      fructose_assert( !BooleanQuery( "NOT foo" ).is_valid() );
+      fructose_assert( !BooleanQuery( "foo AND" ).is_valid() );
+      fructose_assert( !BooleanQuery( "foo bar" ).is_valid() );
+      fructose_assert( !BooleanQuery( "( foo" ).is_valid() );
+      fructose_assert( !BooleanQuery( "foo )" ).is_valid() );
+      fructose_assert( !BooleanQuery( "foo OR OR bar" ).is_valid() );
+
+      // words as the text is read:
+      fructose_assert( "foo" == BooleanQuery( "FoO", true ).words()[ 0 ] );
+      fructose_assert( !BooleanQuery( "foo-bar" ).is_valid() );
+      fructose_assert( !BooleanQuery( "foo AND -" ).is_valid() );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_set_operations", &test::is_proper_set_operations );
+   tests.add_test( "is_proper_gallop", &test::is_proper_gallop );
+   tests.add_test( "is_proper_evaluation", &test::is_proper_evaluation );
+   tests.add_test( "is_proper_syntax_check", &test::is_proper_syntax_check );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
@@ -0,0 +1,103 @@
+/*
+ * Test-ScanKernel.cpp - test scanning kernels.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-ScanKernel.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-ScanKernel.exe Test-ScanKernel.cpp
+
+#include "../src/ScanKernel.h"
+#include <Fructose/test_base.h>
+
+#include <algorithm> // for std::find(), std::count()
+#include <cctype>    // for ::isalpha()
+#include <cstdlib>   // for rand()
+#include <string>    // for std::string
+
+using wordindex::ByteSet;
+
+struct test : public fructose::test_base< test >
+{
+   enum { start = 1, other = 2 };
+
+   unsigned char table[ 256 ];
+   std::string   text;
+
+   void setup()
+   {
+      const std::string alphabet = "abcXYZ09_-;# \t\n\n\x80\xff";
+
+      for ( int i = 0; i < 256; ++i )
+      {
+         table[ i ] = ( '_' == i || ::isalpha( i ) ) ? start : other;
+      }
+      table[ static_cast< unsigned char >( '-' ) ] |= start;
+
+      text.erase();
+      for ( int i = 0; i < 1000; ++i )
+      {
+         text += alphabet[ rand() % alphabet.size() ];
+      }
+   }
+
+   void is_proper_find_in_set( const std::string& test_name )
+   {
+      ByteSet const set( table, start );
+
+      fructose_assert( set.is_vectorizable() );
+
+      for ( std::size_t i = 0; i < text.size(); ++i )
+      {
+         char const* first = text.data() + i;
+         char const* last  = text.data() + text.size();
+
+         long lines1 = 0;
+         long lines2 = 0;
+
+         fructose_assert( wordindex::find_in_set( first, last, set, lines1 ) == wordindex::scan_scalar( first, last, set, false, lines2 ) );
+         fructose_assert( lines1 == lines2 );
+         fructose_assert( wordindex::find_not_in_set( first, last, set ) == wordindex::scan_scalar( first, last, set, true, lines2 ) );
+      }
+   }
+
+   void is_proper_newline_search( const std::string& test_name )
+   {
+      for ( std::size_t i = 0; i < text.size(); ++i )
+      {
+         char const* first = text.data() + i;
+         char const* last  = text.data() + text.size();
+
+         fructose_assert( wordindex::find_newline( first, last ) == std::find( first, last, '\n' ) );
+         fructose_assert( wordindex::count_newlines( first, last ) == std::count( first, last, '\n' ) );
+      }
+   }
+
+   void is_proper_scalar_fallback( const std::string& test_name )
+   {
+      ByteSet const set( table, other );
+
+      fructose_assert( !set.is_vectorizable() );
+
+      long lines = 0;
+      fructose_assert( wordindex::find_in_set( text.data(), text.data() + text.size(), set, lines ) == std::find_if( text.data(), text.data() + text.size(), is_other ) );
+   }
+
+   static bool is_other( const char chr )
+   {
+      return !( '_' == chr || ::isalpha( static_cast< unsigned char >( chr ) ) );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_find_in_set", &test::is_proper_find_in_set );
+   tests.add_test( "is_proper_newline_search", &test::is_proper_newline_search );
+   tests.add_test( "is_proper_scalar_fallback", &test::is_proper_scalar_fallback );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
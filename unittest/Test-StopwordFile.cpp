@@ -0,0 +1,97 @@
+/*
+ * Test-StopwordFile.cpp - test StopwordFile.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-StopwordFile.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-StopwordFile.exe Test-StopwordFile.cpp
+
+#include "../src/StopwordFile.h"
+#include <Fructose/test_base.h>
+
+#include <cstdio>    // for std::remove()
+#include <fstream>   // for std::ofstream
+#include <sstream>   // for std::ostringstream
+#include <string>    // for std::string
+
+using wordindex::StopwordFile;
+using wordindex::StopwordTableBuilder;
+
+struct test : public fructose::test_base< test >
+{
+   std::string filename;
+   std::string contents;
+
+   void setup()
+   {
+      filename = "Test-StopwordFile.kwb";
+
+      StopwordTableBuilder builder;
+
+      for ( int i = 0; i < 1000; ++i )
+      {
+         std::ostringstream os; os << "k" << i;
+         builder.insert( os.str() );
+      }
+      builder.build();
+
+      std::ostringstream os;
+      StopwordFile::write( os, builder.table() );
+      contents = os.str();
+   }
+
+   void teardown()
+   {
+      std::remove( filename.c_str() );
+   }
+
+   void write_file( std::string const& text )
+   {
+      std::ofstream os( filename.c_str(), std::ios::binary );
+      os << text;
+   }
+
+   void is_proper_load( const std::string& test_name )
+   {
+      write_file( contents );
+
+      fructose_assert( StopwordFile::is_stopword_file( filename ) );
+
+      StopwordFile file( filename );
+
+      fructose_assert( file.is_open() );
+      fructose_assert( 1000 == file.table().size() );
+      fructose_assert( 1 == file.table().count( "k0" ) );
+      fructose_assert( 1 == file.table().count( "k999" ) );
+      fructose_assert( 0 == file.table().count( "k1000" ) );
+   }
+
+   void is_proper_rejection( const std::string& test_name )
+   {
+      write_file( "the a an\n" );
+      fructose_assert( !StopwordFile::is_stopword_file( filename ) );
+      fructose_assert( !StopwordFile( filename ).is_open() );
+
+      write_file( contents.substr( 0, contents.size() - 1 ) );
+      fructose_assert( StopwordFile::is_stopword_file( filename ) );
+      fructose_assert( !StopwordFile( filename ).is_open() );
+
+      std::string other_version( contents );
+      other_version[ 4 ] += 1;
+      write_file( other_version );
+      fructose_assert( !StopwordFile( filename ).is_open() );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_load", &test::is_proper_load );
+   tests.add_test( "is_proper_rejection", &test::is_proper_rejection );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
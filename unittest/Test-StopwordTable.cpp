@@ -0,0 +1,97 @@
+/*
+ * Test-StopwordTable.cpp - test StopwordTable and StopwordTableBuilder.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-StopwordTable.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-StopwordTable.exe Test-StopwordTable.cpp
+
+#include "../src/StopwordTable.h"
+#include "../src/Stopwords.h"
+#include <Fructose/test_base.h>
+
+#include <sstream>   // for std::ostringstream
+#include <string>    // for std::string
+
+using wordindex::StopwordTable;
+using wordindex::StopwordTableBuilder;
+
+struct test : public fructose::test_base< test >
+{
+   static std::string word( int const i )
+   {
+      std::ostringstream os; os << "k" << i;
+      return os.str();
+   }
+
+   void is_proper_lookup( const std::string& test_name )
+   {
+      StopwordTableBuilder builder;
+
+      for ( int i = 0; i < 50000; i += 2 )
+      {
+         builder.insert( word( i ) );
+      }
+      builder.insert( word( 0 ) );
+
+      fructose_assert( builder.build() );
+
+      StopwordTable const table = builder.table();
+
+      fructose_assert( 25000 == table.size() );
+
+      for ( int i = 0; i < 50000; ++i )
+      {
+         fructose_assert( ( 0 == i % 2 ) == ( 1 == table.count( word( i ) ) ) );
+      }
+      fructose_assert( 0 == table.count( "" ) );
+   }
+
+   void is_proper_empty_table( const std::string& test_name )
+   {
+      StopwordTableBuilder builder;
+
+      fructose_assert( builder.build() );
+      fructose_assert( 0 == builder.table().size() );
+      fructose_assert( 0 == builder.table().count( "the" ) );
+   }
+
+   void is_proper_builtin_table( const std::string& test_name )
+   {
+      fructose_assert( 1 == wordindex::builtin_stopwords.count( "the" ) );
+      fructose_assert( 1 == wordindex::builtin_stopwords.count( "yourselves" ) );
+      fructose_assert( 0 == wordindex::builtin_stopwords.count( "wordindex" ) );
+   }
+
+   void is_proper_header( const std::string& test_name )
+   {
+      StopwordTableBuilder builder;
+
+      builder.insert( "it's" );
+      builder.insert( "a\\b" );
+
+      fructose_assert( builder.build() );
+
+      std::ostringstream os;
+      builder.write_header( os, "test" );
+
+      fructose_assert( std::string::npos != os.str().find( "constexpr StopwordTable builtin_stopwords" ) );
+      fructose_assert( std::string::npos != os.str().find( "'\\047'" ) );
+      fructose_assert( std::string::npos != os.str().find( "'\\134'" ) );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_lookup", &test::is_proper_lookup );
+   tests.add_test( "is_proper_empty_table", &test::is_proper_empty_table );
+   tests.add_test( "is_proper_builtin_table", &test::is_proper_builtin_table );
+   tests.add_test( "is_proper_header", &test::is_proper_header );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
@@ -0,0 +1,62 @@
+/*
+ * Test-TokenView.cpp - test TokenView.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-TokenView.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-TokenView.exe Test-TokenView.cpp
+
+#include "../src/TokenView.h"
+#include <Fructose/test_base.h>
+
+#include <iomanip>   // for std::setw()
+#include <sstream>   // for std::ostringstream
+#include <string>    // for std::string
+
+using wordindex::TokenView;
+
+struct test : public fructose::test_base< test >
+{
+   static TokenView view( std::string const& s )
+   {
+      return TokenView( s.data(), s.data() + s.size() );
+   }
+
+   void is_proper_compare( const std::string& test_name )
+   {
+      const std::string a( "abc" ), b( "abd" ), c( "ab" ), d( "ab\xe9" );
+
+      fructose_assert( view( a ) == a );
+      fructose_assert( "abc" == view( a ) );
+      fructose_assert( view( a ) != view( b ) );
+      fructose_assert( view( a ) < view( b ) );
+      fructose_assert( view( c ) < view( a ) );
+      fructose_assert( !( view( a ) < view( a ) ) );
+
+      // bytes compare as unsigned, like std::string:
+      fructose_assert( ( view( a ) < view( d ) ) == ( a < d ) );
+   }
+
+   void is_proper_output( const std::string& test_name )
+   {
+      const std::string s( "word" );
+      std::ostringstream os;
+
+      os << std::setw( 6 ) << std::right << view( s ) << "|" << std::setw( 6 ) << std::left << view( s ) << "|" << view( s );
+
+      fructose_assert_eq( std::string( "  word|word  |word" ), os.str() );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_compare", &test::is_proper_compare );
+   tests.add_test( "is_proper_output", &test::is_proper_output );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */
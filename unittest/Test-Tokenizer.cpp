@@ -10,6 +10,8 @@
 #include <Fructose/test_base.h>
 
 using wordindex::Tokenizer;
+using wordindex::RangeTokenizer;
+using wordindex::TokenBatch;
 
 const int number = 321;
 const std::string text1 = "text";
@@ -60,12 +62,108 @@ struct test : public fructose::test_base< test >
 
       fructose_assert( !( pos != tokenizer.end() ) );
    }
+
+   void is_proper_range_token_text( const std::string& test_name )
+   {
+      const std::string text =
+         "321 ~`!@# $%^ &*( ()-+= :;'\" ,./ <>? {}[]\\|\n" +
+         text1 + "\n" +
+         text2 + " " + text3 + "\n\n" +
+         text7;
+
+      RangeTokenizer tokenizer( text.data(), text.data() + text.size() );
+
+      RangeTokenizer::iterator pos( tokenizer.begin() );
+
+      fructose_assert( ( pos != tokenizer.end() ) );
+
+      fructose_assert( text1 == (*pos).first.str() && 2 == (*pos).second ); ++pos;
+      fructose_assert( text2 == (*pos).first.str() && 3 == (*pos).second ); ++pos;
+      fructose_assert( text3 == (*pos).first.str() && 3 == (*pos).second ); ++pos;
+      fructose_assert( text7 == (*pos).first.str() && 5 == (*pos).second ); ++pos;
+
+      fructose_assert( !( pos != tokenizer.end() ) );
+   }
+
+   void is_proper_start_and_follow_set( const std::string& test_name )
+   {
+      const std::string text = "$var -1 file-name.txt 2x";
+
+      RangeTokenizer tokenizer( text.data(), text.data() + text.size() );
+      tokenizer.add_to_start_set( "$" );
+      tokenizer.add_to_followset( "-." );
+
+      RangeTokenizer::iterator pos( tokenizer.begin() );
+
+      fructose_assert( "$var"          == (*pos).first.str() ); ++pos;
+      fructose_assert( "file-name.txt" == (*pos).first.str() ); ++pos;
+      fructose_assert( "x"             == (*pos).first.str() ); ++pos;
+
+      fructose_assert( !( pos != tokenizer.end() ) );
+   }
+
+   void is_proper_comment_skip( const std::string& test_name )
+   {
+      const std::string text = "one # two\n; three\n\n   four ;\nfive";
+
+      RangeTokenizer tokenizer( text.data(), text.data() + text.size() );
+      tokenizer.set_skip_comments();
+
+      RangeTokenizer::iterator pos( tokenizer.begin() );
+
+      fructose_assert( "one"  == (*pos).first.str() && 1 == (*pos).second ); ++pos;
+      fructose_assert( "four" == (*pos).first.str() && 4 == (*pos).second ); ++pos;
+      fructose_assert( "five" == (*pos).first.str() && 5 == (*pos).second ); ++pos;
+
+      fructose_assert( !( pos != tokenizer.end() ) );
+   }
+
+   void is_proper_token_batch( const std::string& test_name )
+   {
+      const std::string text = "One two\n\nThree 4four; five\n Six_6\nseven";
+
+      for ( int lowercase = 0; lowercase < 2; ++lowercase )
+      {
+         RangeTokenizer tokenizer( text.data(), text.data() + text.size() );
+         tokenizer.set_lowercase( 1 == lowercase );
+
+         RangeTokenizer tokenizer2( text.data(), text.data() + text.size() );
+         tokenizer2.set_lowercase( 1 == lowercase );
+
+         TokenBatch batch( tokenizer2, 3 );
+         RangeTokenizer::iterator pos( tokenizer.begin() );
+
+         int batches = 0;
+
+         while ( batch.fill() )
+         {
+            ++batches;
+            fructose_assert( batch.size() <= 3 );
+
+            for ( std::size_t i = 0; i < batch.size(); ++i, ++pos )
+            {
+               fructose_assert( pos != tokenizer.end() );
+               fructose_assert( (*pos).first == batch.token( i ) );
+               fructose_assert( (*pos).second == batch[ i ].line );
+               fructose_assert( pos.hash() == batch[ i ].hash );
+            }
+         }
+
+         fructose_assert( 3 == batches );
+         fructose_assert( !( pos != tokenizer.end() ) );
+         fructose_assert( !batch.fill() && batch.empty() );
+      }
+   }
 };
 
 int main( int argc, char* argv[] )
 {
    test tests;
    tests.add_test( "is_proper_token_text", &test::is_proper_token_text );
+   tests.add_test( "is_proper_range_token_text", &test::is_proper_range_token_text );
+   tests.add_test( "is_proper_start_and_follow_set", &test::is_proper_start_and_follow_set );
+   tests.add_test( "is_proper_comment_skip", &test::is_proper_comment_skip );
+   tests.add_test( "is_proper_token_batch", &test::is_proper_token_batch );
 
    return tests.run( argc, argv );
 }
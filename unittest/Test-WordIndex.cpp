@@ -9,20 +9,173 @@
 #include "../src/WordIndex.h"
 #include <Fructose/test_base.h>
 
+#include <sstream>   // for std::ostringstream
+#include <string>    // for std::string
+#include <vector>    // for std::vector
+
 using wordindex::WordIndex;
 
 struct test : public fructose::test_base< test >
 {
-   void is_proper_( const std::string& test_name )
+   static std::vector< int > lines( wordindex::Postings const& postings )
+   {
+      return std::vector< int >( postings.begin(), postings.end() );
+   }
+
+   void is_proper_insert( const std::string& test_name )
+   {
+      WordIndex index;
+
+      index.insert( "b", 2 );
+      index.insert( "a", 1 );
+      index.insert( "b", 3 );
+
+      fructose_assert( 2 == index.words() );
+      fructose_assert( 3 == index.lines() );
+
+      WordIndex::const_iterator pos = index.begin();
+
+      int const b[] = { 2, 3 };
+      fructose_assert( "a" == pos->first && 1 == pos->second.size() ); ++pos;
+      fructose_assert( "b" == pos->first && lines( pos->second ) == std::vector< int >( b, b + 2 ) ); ++pos;
+      fructose_assert( index.end() == pos );
+   }
+
+   void is_proper_order( const std::string& test_name )
+   {
+      WordIndex index;
+
+      // more words than the initial hash table holds, inserted in descending order:
+      for ( int i = 5000; i > 0; --i )
+      {
+         std::ostringstream os; os << "w" << i;
+         index.insert( os.str(), i );
+      }
+      index.insert( "Z", 0 );
+      index.insert( "_", 0 );
+
+      fructose_assert( 5002 == index.words() );
+
+      std::string previous;
+      for ( WordIndex::const_iterator pos = index.begin(); pos != index.end(); ++pos )
+      {
+         fructose_assert( previous < pos->first.str() );
+         previous = pos->first.str();
+      }
+
+      // order is byte-wise:
+      fructose_assert( "Z" == index.begin()->first );
+   }
+
+   void is_proper_sort_after_insert( const std::string& test_name )
+   {
+      WordIndex index;
+
+      index.insert( "b", 1 );
+      fructose_assert( "b" == index.begin()->first );
+
+      index.insert( "a", 2 );
+      fructose_assert( "a" == index.begin()->first );
+      fructose_assert( 2 == std::distance( index.begin(), index.end() ) );
+   }
+
+   void is_proper_find( const std::string& test_name )
+   {
+      WordIndex index;
+
+      for ( int i = 500; i > 0; --i )
+      {
+         std::ostringstream os; os << "w" << i;
+         index.insert( os.str(), i );
+      }
+
+      fructose_assert( index.end() == index.find( "w0" ) );
+      fructose_assert( index.end() == index.find( "" ) );
+      fructose_assert( "w123" == index.find( "w123" )->first );
+      fructose_assert( 123 == *index.find( "w123" )->second.begin() );
+
+      // the found position is the word's position in order:
+      WordIndex::const_iterator pos = index.find( "w49" );
+      fructose_assert( "w490" == ( ++pos )->first );
+
+      index.insert( "a", 1 );
+      fructose_assert( "a" == index.find( "a" )->first );
+   }
+
+   void is_proper_append( const std::string& test_name )
+   {
+      WordIndex index;
+      WordIndex other;
+
+      index.insert( "a", 1 );
+      other.insert( "a", 2 );
+      other.insert( "b", 1 );
+
+      index.append( other, 10 );
+
+      int const a[] = { 1, 12 };
+      fructose_assert( 2 == index.words() );
+      fructose_assert( 3 == index.lines() );
+      fructose_assert( lines( index.begin()->second ) == std::vector< int >( a, a + 2 ) );
+   }
+
+   void is_proper_splice( const std::string& test_name )
    {
-      fructose_assert( 0 && "implement" );
+      WordIndex index;
+      WordIndex other;
+
+      index.insert( "a", 1 );
+      other.insert( "a", 2 );
+      other.insert( "b", 1 );
+
+      index.splice( other );
+
+      int const a[] = { 1, 2 };
+      fructose_assert( 2 == index.words() );
+      fructose_assert( 3 == index.lines() );
+      fructose_assert( lines( index.begin()->second ) == std::vector< int >( a, a + 2 ) );
+      fructose_assert( 0 == other.words() && 0 == other.lines() );
+      fructose_assert( other.begin() == other.end() );
+   }
+
+   void is_proper_count_only( const std::string& test_name )
+   {
+      WordIndex index;
+      WordIndex other;
+
+      index.set_count_only();
+      other.set_count_only();
+
+      index.insert( "a", 1 );
+      index.insert( "a", 2 );
+      other.insert( "a", 3 );
+      other.insert( "b", 4 );
+
+      index.splice( other );
+
+      fructose_assert( index.count_only() );
+      fructose_assert( 2 == index.words() );
+      fructose_assert( 4 == index.lines() );
+
+      WordIndex::const_iterator pos = index.begin();
+
+      fructose_assert( "a" == pos->first && 3 == pos->count && pos->second.empty() ); ++pos;
+      fructose_assert( "b" == pos->first && 1 == pos->count && pos->second.empty() ); ++pos;
+      fructose_assert( index.end() == pos );
+      fructose_assert( 0 == index.postings_size() );
    }
 };
 
 int main( int argc, char* argv[] )
 {
    test tests;
-   tests.add_test( "is_proper_", &test::is_proper_ );
+   tests.add_test( "is_proper_insert", &test::is_proper_insert );
+   tests.add_test( "is_proper_order", &test::is_proper_order );
+   tests.add_test( "is_proper_sort_after_insert", &test::is_proper_sort_after_insert );
+   tests.add_test( "is_proper_find", &test::is_proper_find );
+   tests.add_test( "is_proper_append", &test::is_proper_append );
+   tests.add_test( "is_proper_splice", &test::is_proper_splice );
+   tests.add_test( "is_proper_count_only", &test::is_proper_count_only );
 
    return tests.run( argc, argv );
 }
@@ -0,0 +1,199 @@
+/*
+ * Test-WordTrie.cpp - test the trie of words for prefix and wildcard lookups.
+ */
+
+// VC6: cannot compile
+// VC7: cl -GX -GR -I ../include Test-WordTrie.cpp
+// GCC: C:\Programs\MinGW\bin\g++.exe -I ../include -o Test-WordTrie.exe Test-WordTrie.cpp
+
+#include "../src/WordTrie.h"
+#include <Fructose/test_base.h>
+
+#include <algorithm> // for std::sort(), std::unique()
+#include <cstdlib>   // for rand()
+#include <string>    // for std::string
+#include <vector>    // for std::vector<>
+
+using wordindex::WordTrie;
+
+struct test : public fructose::test_base< test >
+{
+   std::vector< std::string > words;
+
+   void setup()
+   {
+      words.clear();
+
+      // short words of a small alphabet share many prefixes:
+      for ( int i = 0; i < 500; ++i )
+      {
+         std::string word;
+
+         for ( int n = 1 + rand() % 5; n > 0; --n )
+         {
+            word += "abc"[ rand() % 3 ];
+         }
+         words.push_back( word );
+      }
+
+      std::sort( words.begin(), words.end() );
+      words.erase( std::unique( words.begin(), words.end() ), words.end() );
+   }
+
+   /**
+    * true if the word matches the pattern, the simple way.
+    */
+   static bool matches( char const* pattern, char const* word )
+   {
+      if ( '\0' == *pattern )
+      {
+         return '\0' == *word;
+      }
+
+      if ( '*' == *pattern )
+      {
+         return matches( pattern + 1, word ) || ( '\0' != *word && matches( pattern, word + 1 ) );
+      }
+
+      return '\0' != *word && ( '?' == *pattern || *pattern == *word ) && matches( pattern + 1, word + 1 );
+   }
+
+   void is_proper_prefix_range( const std::string& test_name )
+   {
+      WordTrie const trie( words );
+
+      fructose_assert( words.size() == trie.words() );
+
+      char const* const prefixes[] = { "", "a", "b", "ab", "cab", "abca", "ccccc", "aaaaaa", "d" };
+
+      for ( std::size_t i = 0; i < sizeof prefixes / sizeof *prefixes; ++i )
+      {
+         std::string const prefix = prefixes[ i ];
+
+         WordTrie::range_type const range = trie.prefix_range( prefix );
+
+         for ( std::size_t n = 0; n < words.size(); ++n )
+         {
+            bool const inside = range.first <= n && n < range.second;
+
+            fructose_assert( inside == ( 0 == words[ n ].compare( 0, prefix.size(), prefix ) ) );
+         }
+      }
+   }
+
+   void is_proper_match( const std::string& test_name )
+   {
+      WordTrie const trie( words );
+
+      char const* const patterns[] = { "*", "a*", "*a", "?", "??", "a?c", "*b*", "a*c*b", "**", "?*?", "abc", "ccc?c", "*d*" };
+
+      WordTrie::numbers_type numbers;
+
+      for ( std::size_t i = 0; i < sizeof patterns / sizeof *patterns; ++i )
+      {
+         trie.match( patterns[ i ], numbers );
+
+         WordTrie::numbers_type expected;
+
+         for ( std::size_t n = 0; n < words.size(); ++n )
+         {
+            if ( matches( patterns[ i ], words[ n ].c_str() ) )
+            {
+               expected.push_back( static_cast< WordTrie::size_type >( n ) );
+            }
+         }
+
+         fructose_assert( expected == numbers );
+      }
+   }
+
+   void is_proper_match_of_long_word( const std::string& test_name )
+   {
+      // a long run of one character matches many stars in many ways:
+      std::string const run( 60, 'a' );
+
+      std::vector< std::string > long_words;
+      long_words.push_back( run );
+      long_words.push_back( run + "b" );
+      long_words.push_back( run + "c" );
+      long_words.push_back( run + "cb" );
+
+      WordTrie const trie( long_words );
+
+      WordTrie::numbers_type numbers;
+
+      trie.match( "*a*a*a*a*a*a*a*a*a*a*c", numbers );
+      fructose_assert( 1 == numbers.size() && 2 == numbers[ 0 ] );
+
+      trie.match( "*a*a*a*a*a*a*a*a*a*a*d", numbers );
+      fructose_assert( numbers.empty() );
+
+      trie.match( "a*a*a*a*a*a*a*a*a*a*", numbers );
+      fructose_assert( long_words.size() == numbers.size() );
+
+      trie.match( "*a?a*a*a*a*a*a*a*a*b", numbers );
+      fructose_assert( 2 == numbers.size() && 1 == numbers[ 0 ] && 3 == numbers[ 1 ] );
+   }
+
+   void is_proper_empty_trie( const std::string& test_name )
+   {
+      WordTrie const trie;
+
+      WordTrie::numbers_type numbers;
+      trie.match( "*", numbers );
+
+      fructose_assert( 0 == trie.nodes() );
+      fructose_assert( 0 == trie.words() );
+      fructose_assert( numbers.empty() );
+      fructose_assert( trie.prefix_range( "" ).first == trie.prefix_range( "" ).second );
+   }
+
+   void is_proper_attach( const std::string& test_name )
+   {
+      WordTrie const made( words );
+
+      std::vector< WordTrie::size_type > numbers( made.numbers(), made.numbers() + WordTrie::numbers_size( made.nodes() ) );
+      std::string const chars( made.chars(), made.chars_size() );
+
+      WordTrie trie;
+
+      fructose_assert( trie.attach( made.nodes(), &numbers[ 0 ], chars.data(), chars.size(), made.words() ) );
+      fructose_assert( made.nodes() == trie.nodes() );
+      fructose_assert( made.prefix_range( "ab" ) == trie.prefix_range( "ab" ) );
+
+      WordTrie::numbers_type expected, actual;
+      made.match( "*b?", expected );
+      trie.match( "*b?", actual );
+
+      fructose_assert( expected == actual );
+
+      // other number of words, of characters:
+      fructose_assert( !trie.attach( made.nodes(), &numbers[ 0 ], chars.data(), chars.size(), made.words() + 1 ) );
+      fructose_assert( !trie.attach( made.nodes(), &numbers[ 0 ], chars.data(), chars.size() - 1, made.words() ) );
+
+      // children that do not follow their parent are not visited:
+      numbers[ made.nodes() + 1 ] = 0;
+
+      fructose_assert( trie.attach( made.nodes(), &numbers[ 0 ], chars.data(), chars.size(), made.words() ) );
+      fructose_assert( trie.prefix_range( "ab" ).first == trie.prefix_range( "ab" ).second );
+
+      trie.match( "*", actual );
+      fructose_assert( words.size() == actual.size() );
+   }
+};
+
+int main( int argc, char* argv[] )
+{
+   test tests;
+   tests.add_test( "is_proper_prefix_range", &test::is_proper_prefix_range );
+   tests.add_test( "is_proper_match", &test::is_proper_match );
+   tests.add_test( "is_proper_match_of_long_word", &test::is_proper_match_of_long_word );
+   tests.add_test( "is_proper_empty_trie", &test::is_proper_empty_trie );
+   tests.add_test( "is_proper_attach", &test::is_proper_attach );
+
+   return tests.run( argc, argv );
+}
+
+/*
+ * end of file
+ */